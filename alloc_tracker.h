@@ -0,0 +1,299 @@
+#ifndef ALLOC_TRACKER_H
+#define ALLOC_TRACKER_H
+
+#include <cstddef> // for std::size_t
+#include <cstdlib> // for std::malloc
+#include <new> // for std::bad_alloc
+
+#if defined(_MSC_VER)
+# include <intrin.h> // for _ReturnAddress
+# include <malloc.h> // for _aligned_malloc
+#endif // defined(_MSC_VER)
+
+/// heap usage counted by an AllocScope
+struct AllocCounts
+{
+  unsigned long allocations = 0;
+  unsigned long deallocations = 0;
+  std::size_t bytes = 0;  ///< total bytes allocated
+  long long current = 0;  ///< bytes allocated minus bytes freed
+  long long peak = 0;  ///< maximum of current
+};
+
+/// @brief  counts the heap allocations of the current thread during its lifetime
+/// @note  replaces the global operator new and delete; like tracer.h this
+///        header defines globals and must be included by one translation unit only
+/// @note  use as
+///          AllocScope scope;
+///          workQueue.Assign(fn);
+///          assert(scope.Counts().allocations == 0);
+/// @note  scopes may be nested; allocations count towards all enclosing scopes
+class AllocScope
+{
+public:
+  /// number of call sites recorded by a capturing scope
+  static constexpr std::size_t maxCallSites = 16U;
+
+  /// @param  captureCallSites  record the return addresses of the first
+  ///         maxCallSites allocations, e.g. for addr2line
+  explicit AllocScope(bool captureCallSites = false)
+    : m_parent(current())
+    , m_captureCallSites(captureCallSites)
+  {
+    current() = this;
+  }
+
+  ~AllocScope()
+  {
+    current() = m_parent;
+  }
+
+  AllocScope(AllocScope const &) = delete;
+  AllocScope &operator=(AllocScope const &) = delete;
+
+  AllocCounts const &Counts() const noexcept
+  {
+    return m_counts;
+  }
+
+  /// @return  return addresses within the allocating functions
+  void const *const *CallSites() const noexcept
+  {
+    return m_callSites;
+  }
+
+  /// @return  number of valid entries in CallSites, none if not capturing
+  std::size_t CallSiteCount() const noexcept
+  {
+    if(!m_captureCallSites) {
+      return 0U;
+    }
+    return (m_counts.allocations < maxCallSites ?
+            static_cast<std::size_t>(m_counts.allocations) : maxCallSites);
+  }
+
+  /// @brief  account an allocation on the current thread
+  /// @note  called by the replaced operator new only
+  static void Allocated(std::size_t size, void const *callSite) noexcept
+  {
+    for(auto scope = current(); scope; scope = scope->m_parent) {
+      auto &counts = scope->m_counts;
+      if(scope->m_captureCallSites && (counts.allocations < maxCallSites)) {
+        scope->m_callSites[counts.allocations] = callSite;
+      }
+      ++counts.allocations;
+      counts.bytes += size;
+      counts.current += static_cast<long long>(size);
+      if(counts.current > counts.peak) {
+        counts.peak = counts.current;
+      }
+    }
+  }
+
+  /// @brief  account a deallocation on the current thread
+  /// @note  called by the replaced operator delete only
+  static void Deallocated(std::size_t size) noexcept
+  {
+    for(auto scope = current(); scope; scope = scope->m_parent) {
+      ++scope->m_counts.deallocations;
+      scope->m_counts.current -= static_cast<long long>(size);
+    }
+  }
+
+private:
+  static AllocScope *&current() noexcept
+  {
+    thread_local AllocScope *scope = nullptr;
+    return scope;
+  }
+
+private:
+  AllocScope *const m_parent;
+  bool const m_captureCallSites;
+  AllocCounts m_counts;
+  void const *m_callSites[maxCallSites] = {};
+};
+
+namespace alloc_tracker_detail {
+
+  // every block is preceded by a header holding its size so that
+  // unsized deallocations can be accounted as well
+  constexpr std::size_t headerSize = alignof(std::max_align_t);
+
+  inline std::size_t HeaderSize(std::size_t alignment) noexcept
+  {
+    return (alignment > headerSize ? alignment : headerSize);
+  }
+
+  inline void *Allocate(std::size_t size, std::size_t alignment, void const *callSite) noexcept
+  {
+    auto const header = HeaderSize(alignment);
+    void *block;
+    if(alignment > headerSize) {
+#if defined(_MSC_VER)
+      block = _aligned_malloc(header + size, alignment);
+#else // defined(_MSC_VER)
+      // std::aligned_alloc requires a multiple of the alignment
+      block = std::aligned_alloc(alignment, (header + size + alignment - 1U) / alignment * alignment);
+#endif // defined(_MSC_VER)
+    } else {
+      block = std::malloc(header + size);
+    }
+    if(!block) {
+      return nullptr;
+    }
+
+    auto const ptr = static_cast<char *>(block) + header;
+    *reinterpret_cast<std::size_t *>(ptr - sizeof(std::size_t)) = size;
+    AllocScope::Allocated(size, callSite);
+    return ptr;
+  }
+
+  inline void Deallocate(void *ptr, std::size_t alignment) noexcept
+  {
+    if(!ptr) {
+      return;
+    }
+
+    auto const p = static_cast<char *>(ptr);
+    AllocScope::Deallocated(*reinterpret_cast<std::size_t *>(p - sizeof(std::size_t)));
+#if defined(_MSC_VER)
+    if(alignment > headerSize) {
+      _aligned_free(p - HeaderSize(alignment));
+      return;
+    }
+#endif // defined(_MSC_VER)
+    std::free(p - HeaderSize(alignment));
+  }
+
+  inline void *AllocateOrThrow(std::size_t size, std::size_t alignment, void const *callSite)
+  {
+    for(;;) {
+      if(auto const ptr = Allocate(size, alignment, callSite)) {
+        return ptr;
+      }
+
+      // mimic the standard operator new
+      auto const handler = std::get_new_handler();
+      if(!handler) {
+        throw std::bad_alloc();
+      }
+      handler();
+    }
+  }
+
+} // namespace alloc_tracker_detail
+
+#if defined(_MSC_VER)
+# define ALLOC_TRACKER_CALL_SITE _ReturnAddress()
+#else // defined(_MSC_VER)
+# define ALLOC_TRACKER_CALL_SITE __builtin_return_address(0)
+#endif // defined(_MSC_VER)
+
+void *operator new(std::size_t size)
+{
+  return alloc_tracker_detail::AllocateOrThrow(size, 0U, ALLOC_TRACKER_CALL_SITE);
+}
+
+void *operator new[](std::size_t size)
+{
+  return alloc_tracker_detail::AllocateOrThrow(size, 0U, ALLOC_TRACKER_CALL_SITE);
+}
+
+void *operator new(std::size_t size, std::nothrow_t const &) noexcept
+{
+  return alloc_tracker_detail::Allocate(size, 0U, ALLOC_TRACKER_CALL_SITE);
+}
+
+void *operator new[](std::size_t size, std::nothrow_t const &) noexcept
+{
+  return alloc_tracker_detail::Allocate(size, 0U, ALLOC_TRACKER_CALL_SITE);
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment)
+{
+  return alloc_tracker_detail::AllocateOrThrow(
+    size, static_cast<std::size_t>(alignment), ALLOC_TRACKER_CALL_SITE);
+}
+
+void *operator new[](std::size_t size, std::align_val_t alignment)
+{
+  return alloc_tracker_detail::AllocateOrThrow(
+    size, static_cast<std::size_t>(alignment), ALLOC_TRACKER_CALL_SITE);
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment, std::nothrow_t const &) noexcept
+{
+  return alloc_tracker_detail::Allocate(
+    size, static_cast<std::size_t>(alignment), ALLOC_TRACKER_CALL_SITE);
+}
+
+void *operator new[](std::size_t size, std::align_val_t alignment, std::nothrow_t const &) noexcept
+{
+  return alloc_tracker_detail::Allocate(
+    size, static_cast<std::size_t>(alignment), ALLOC_TRACKER_CALL_SITE);
+}
+
+#undef ALLOC_TRACKER_CALL_SITE
+
+void operator delete(void *ptr) noexcept
+{
+  alloc_tracker_detail::Deallocate(ptr, 0U);
+}
+
+void operator delete[](void *ptr) noexcept
+{
+  alloc_tracker_detail::Deallocate(ptr, 0U);
+}
+
+void operator delete(void *ptr, std::nothrow_t const &) noexcept
+{
+  alloc_tracker_detail::Deallocate(ptr, 0U);
+}
+
+void operator delete[](void *ptr, std::nothrow_t const &) noexcept
+{
+  alloc_tracker_detail::Deallocate(ptr, 0U);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept
+{
+  alloc_tracker_detail::Deallocate(ptr, 0U);
+}
+
+void operator delete[](void *ptr, std::size_t) noexcept
+{
+  alloc_tracker_detail::Deallocate(ptr, 0U);
+}
+
+void operator delete(void *ptr, std::align_val_t alignment) noexcept
+{
+  alloc_tracker_detail::Deallocate(ptr, static_cast<std::size_t>(alignment));
+}
+
+void operator delete[](void *ptr, std::align_val_t alignment) noexcept
+{
+  alloc_tracker_detail::Deallocate(ptr, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void *ptr, std::size_t, std::align_val_t alignment) noexcept
+{
+  alloc_tracker_detail::Deallocate(ptr, static_cast<std::size_t>(alignment));
+}
+
+void operator delete[](void *ptr, std::size_t, std::align_val_t alignment) noexcept
+{
+  alloc_tracker_detail::Deallocate(ptr, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void *ptr, std::align_val_t alignment, std::nothrow_t const &) noexcept
+{
+  alloc_tracker_detail::Deallocate(ptr, static_cast<std::size_t>(alignment));
+}
+
+void operator delete[](void *ptr, std::align_val_t alignment, std::nothrow_t const &) noexcept
+{
+  alloc_tracker_detail::Deallocate(ptr, static_cast<std::size_t>(alignment));
+}
+
+#endif // ALLOC_TRACKER_H
@@ -0,0 +1,498 @@
+#include "fire_and_dont_forget.h"
+#include "iterator_custom_step.h"
+#include "iterator_prefetch.h"
+#include "iterator_tiled.h"
+#include "print_async.h"
+#include "print_unmangled.h"
+#include "resource_pool.h"
+#include "work_queue.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <list>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+// benchmarks of the concurrency primitives and the iterator adaptors;
+// writes its results as JSON to the file given as first argument or to stdout
+//
+// usage: helper_bench [results.json]
+
+namespace {
+
+  using Clock = std::chrono::steady_clock;
+
+  std::int64_t Now()
+  {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      Clock::now().time_since_epoch()).count();
+  }
+
+  double PerSecond(std::size_t count, std::int64_t ns)
+  {
+    return (ns > 0 ? static_cast<double>(count) * 1e9 / static_cast<double>(ns) : 0.0);
+  }
+
+  /// start all threads at once to measure them under contention
+  class StartingGun
+  {
+  public:
+    explicit StartingGun(unsigned threads)
+      : m_waiting(threads)
+    {}
+
+    void Wait()
+    {
+      m_waiting.fetch_sub(1U);
+      while(m_waiting.load() != 0U) {
+        std::this_thread::yield();
+      }
+    }
+
+  private:
+    std::atomic<unsigned> m_waiting;
+  };
+
+  /// streambuf swallowing all output
+  struct NullBuffer : std::streambuf
+  {
+    int overflow(int c) override
+    {
+      return c;
+    }
+
+    std::streamsize xsputn(char const *, std::streamsize n) override
+    {
+      return n;
+    }
+  };
+
+  /// flat JSON records of one benchmark run each
+  class Results
+  {
+  public:
+    Results &Begin(char const *name)
+    {
+      m_os << (m_count++ ? ",\n" : "\n") << "    {\"name\": \"" << name << '"';
+      return *this;
+    }
+
+    template<typename T>
+    Results &Add(char const *key, T const &value)
+    {
+      m_os << ", \"" << key << "\": " << value;
+      return *this;
+    }
+
+    Results &Add(char const *key, char const *value)
+    {
+      m_os << ", \"" << key << "\": \"" << value << '"';
+      return *this;
+    }
+
+    /// @param  samples  latencies in ns; sorted in place
+    Results &AddPercentiles(char const *key, std::vector<std::int64_t> &samples)
+    {
+      std::sort(std::begin(samples), std::end(samples));
+      auto const at = [&](double p) -> std::int64_t {
+        return (samples.empty() ? 0 :
+          samples[static_cast<std::size_t>(p * static_cast<double>(samples.size() - 1U))]);
+      };
+      m_os << ", \"" << key << "\": {"
+           << "\"p50\": " << at(0.5)
+           << ", \"p90\": " << at(0.9)
+           << ", \"p99\": " << at(0.99)
+           << ", \"p999\": " << at(0.999)
+           << ", \"max\": " << at(1.0) << '}';
+      return *this;
+    }
+
+    void End()
+    {
+      m_os << '}';
+    }
+
+    void Write(std::ostream &os) const
+    {
+      os << "{\n  \"benchmarks\": [" << m_os.str() << "\n  ]\n}\n";
+    }
+
+  private:
+    std::ostringstream m_os;
+    std::size_t m_count = 0U;
+  };
+
+  unsigned const threadCounts[] = {1U, 2U, 4U, 8U};
+
+  /// @return  fastest of a few runs of fn in ns
+  template<typename Fn>
+  std::int64_t BestOf(unsigned runs, Fn fn)
+  {
+    std::int64_t best = 0;
+    for(unsigned run = 0U; run < runs; ++run) {
+      auto const begin = Now();
+      fn();
+      auto const ns = Now() - begin;
+      best = ((run == 0U) || (ns < best) ? ns : best);
+    }
+    return best;
+  }
+
+} // namespace
+
+namespace work_queue {
+  void bench(Results &results)
+  {
+    std::size_t const tasks = 100000U;
+
+    for(auto producers : threadCounts) {
+      std::vector<std::int64_t> submitted(tasks);
+      std::vector<std::int64_t> ran(tasks);
+      std::int64_t begin;
+      std::int64_t end;
+      {
+        WorkQueue workQueue;
+
+        // let the worker record when it ran each task
+        auto const task = [&ran](std::size_t i) {
+          ran[i] = Now();
+        };
+
+        StartingGun gun(producers + 1U);
+        std::vector<std::thread> threads;
+        for(unsigned p = 0U; p < producers; ++p) {
+          threads.emplace_back([&, p]() {
+            gun.Wait();
+            for(auto i = p; i < tasks; i += producers) {
+              submitted[i] = Now();
+              workQueue.Assign(task, i);
+            }
+          });
+        }
+
+        gun.Wait();
+        begin = Now();
+        for(auto &&t : threads) {
+          t.join();
+        }
+
+        // tasks are run in order so waiting for an extra one waits for all
+        workQueue.Assign([]() {}).wait();
+        end = *std::max_element(std::begin(ran), std::end(ran));
+      }
+
+      std::vector<std::int64_t> latencies(tasks);
+      for(std::size_t i = 0U; i < tasks; ++i) {
+        latencies[i] = ran[i] - submitted[i];
+      }
+
+      results.Begin("WorkQueue::Assign")
+        .Add("producers", producers)
+        .Add("tasks", tasks)
+        .Add("tasks_per_s", PerSecond(tasks, end - begin))
+        .AddPercentiles("submit_to_run_ns", latencies)
+        .End();
+    }
+  }
+} // namespace work_queue
+
+namespace resource_pool {
+  void bench(Results &results)
+  {
+    std::size_t const cycles = 200000U;
+
+    for(auto threadCount : threadCounts) {
+      // one resource per thread so that Get never runs out
+      ResourcePool<std::int64_t> pool(threadCount);
+
+      StartingGun gun(threadCount + 1U);
+      std::vector<std::thread> threads;
+      for(unsigned t = 0U; t < threadCount; ++t) {
+        threads.emplace_back([&]() {
+          gun.Wait();
+          for(auto i = cycles / threadCount; i > 0U; --i) {
+            auto resource = pool.Get(0);
+            ++*resource;
+          }
+        });
+      }
+
+      gun.Wait();
+      auto const begin = Now();
+      for(auto &&t : threads) {
+        t.join();
+      }
+      auto const end = Now();
+
+      results.Begin("ResourcePool::Get+Return")
+        .Add("threads", threadCount)
+        .Add("cycles", cycles)
+        .Add("cycles_per_s", PerSecond(cycles, end - begin))
+        .End();
+    }
+  }
+} // namespace resource_pool
+
+namespace fire_and_dont_forget {
+  void bench(Results &results)
+  {
+    std::size_t const workLoads = 2000U;
+
+    std::atomic<std::size_t> done(0U);
+    std::int64_t dispatched;
+    std::int64_t end;
+    auto const begin = Now();
+    {
+      FireAndDontForget fireAndDontForget;
+      for(std::size_t i = 0U; i < workLoads; ++i) {
+        fireAndDontForget.Dispatch([&done]() {
+          done.fetch_add(1U);
+        });
+      }
+      dispatched = Now();
+    }
+    end = Now();
+
+    results.Begin("FireAndDontForget::Dispatch")
+      .Add("work_loads", workLoads)
+      .Add("dispatches_per_s", PerSecond(workLoads, dispatched - begin))
+      .Add("completions_per_s", PerSecond(done.load(), end - begin))
+      .End();
+  }
+} // namespace fire_and_dont_forget
+
+namespace print_unmangled {
+  void run(Results &results, char const *sinkName, unsigned threadCount,
+           std::ostream &os, PrintSink *sink)
+  {
+    std::size_t const lines = 200000U;
+
+    StartingGun gun(threadCount + 1U);
+    std::vector<std::thread> threads;
+    for(unsigned t = 0U; t < threadCount; ++t) {
+      threads.emplace_back([&, t]() {
+        gun.Wait();
+        for(auto i = lines / threadCount; i > 0U; --i) {
+          if(sink) {
+            PrintUnmangled(*sink) << "thread " << t << " line " << i << " value " << 0.25 * i << '\n';
+          } else {
+            PrintUnmangled(os) << "thread " << t << " line " << i << " value " << 0.25 * i << '\n';
+          }
+        }
+      });
+    }
+
+    gun.Wait();
+    auto const begin = Now();
+    for(auto &&t : threads) {
+      t.join();
+    }
+    auto const end = Now();
+
+    results.Begin("PrintUnmangled")
+      .Add("sink", sinkName)
+      .Add("threads", threadCount)
+      .Add("lines", lines)
+      .Add("lines_per_s", PerSecond(lines, end - begin))
+      .End();
+  }
+
+  void bench(Results &results)
+  {
+    NullBuffer nullBuffer;
+    std::ostream nullStream(&nullBuffer);
+
+    for(auto threadCount : threadCounts) {
+      run(results, "ostream", threadCount, nullStream, nullptr);
+    }
+
+    // the time to drain the queue is not included
+    for(auto threadCount : threadCounts) {
+      PrintAsync printAsync(nullStream);
+      run(results, "PrintAsync", threadCount, nullStream, &printAsync);
+    }
+  }
+} // namespace print_unmangled
+
+namespace iterator_tiled {
+  void bench(Results &results)
+  {
+    std::ptrdiff_t const edge = 4096;
+
+    std::vector<float> src(static_cast<std::size_t>(edge * edge));
+    std::vector<float> dst(src.size());
+    for(std::size_t i = 0U; i < src.size(); ++i) {
+      src[i] = static_cast<float>(i);
+    }
+    auto const in = make_matrix_view(std::begin(src), edge, edge);
+    auto const out = make_matrix_view(std::begin(dst), edge, edge);
+
+    // row by row, writing dst column by column
+    auto const naive = BestOf(3U, [&]() {
+      for(std::ptrdiff_t r = 0; r < edge; ++r) {
+        for(std::ptrdiff_t c = 0; c < edge; ++c) {
+          out(c, r) = in(r, c);
+        }
+      }
+    });
+    auto const blocked = BestOf(3U, [&]() {
+      blocked_transpose(in, out);
+    });
+
+    results.Begin("transpose")
+      .Add("rows", edge)
+      .Add("cols", edge)
+      .Add("element", "float")
+      .Add("naive_ms", static_cast<double>(naive) / 1e6)
+      .Add("blocked_ms", static_cast<double>(blocked) / 1e6)
+      .End();
+  }
+} // namespace iterator_tiled
+
+namespace iterator_prefetch {
+  /// keeps the sums from being optimized away
+  double volatile sink = 0.0;
+
+  void add(Results &results, char const *walk, std::size_t elements,
+           std::ptrdiff_t distance, std::int64_t plain, std::int64_t prefetched)
+  {
+    results.Begin("make_prefetch_iterator")
+      .Add("walk", walk)
+      .Add("elements", elements)
+      .Add("distance", distance)
+      .Add("plain_ms", static_cast<double>(plain) / 1e6)
+      .Add("prefetch_ms", static_cast<double>(prefetched) / 1e6)
+      .End();
+  }
+
+  void bench(Results &results)
+  {
+    std::mt19937 rng(42U);
+
+    { // one column per cache line through rows of 4099 doubles, a page apart
+      std::ptrdiff_t const rows = 8192;
+      std::ptrdiff_t const step = 4099;
+      std::ptrdiff_t const line = 64 / sizeof(double);
+      std::ptrdiff_t const distance = 16;
+      // one row of padding, so that the columns' ends lie within the data
+      std::vector<double> data(static_cast<std::size_t>((rows + 1) * step), 1.0);
+
+      auto const walk = [&](bool prefetch) {
+        double sum = 0.0;
+        for(std::ptrdiff_t col = 0; col < step; col += line) {
+          auto const first = make_custom_step_iterator(std::begin(data) + col, step);
+          auto const last = make_custom_step_iterator(std::begin(data) + rows * step + col, step);
+          if(prefetch) {
+            for(auto it = make_prefetch_iterator(first, last, distance); it != last; ++it) {
+              sum += *it;
+            }
+          } else {
+            for(auto it = first; it != last; ++it) {
+              sum += *it;
+            }
+          }
+        }
+        sink = sum;
+      };
+      add(results, "custom_step_iterator", static_cast<std::size_t>(rows * ((step + line - 1) / line)), distance,
+          BestOf(3U, [&]() { walk(false); }),
+          BestOf(3U, [&]() { walk(true); }));
+    }
+
+    { // list of pointers to shuffled payloads
+      std::size_t const elements = 4U << 20;
+      std::ptrdiff_t const distance = 4;
+      std::vector<double> payloads(elements, 1.0);
+      std::vector<double *> order(elements);
+      for(std::size_t i = 0U; i < elements; ++i) {
+        order[i] = &payloads[i];
+      }
+      std::shuffle(std::begin(order), std::end(order), rng);
+      std::list<double *> const list(std::begin(order), std::end(order));
+
+      auto const payload = [](std::list<double *>::const_iterator const &it) -> void const * {
+        return *it;
+      };
+      add(results, "std::list payloads", elements, distance,
+          BestOf(3U, [&]() {
+            double sum = 0.0;
+            for(auto it = std::begin(list); it != std::end(list); ++it) {
+              sum += **it;
+            }
+            sink = sum;
+          }),
+          BestOf(3U, [&]() {
+            double sum = 0.0;
+            for(auto it = make_prefetch_iterator(std::begin(list), std::end(list), distance, payload);
+                it != std::end(list); ++it) {
+              sum += **it;
+            }
+            sink = sum;
+          }));
+    }
+
+    { // random indices into a 256 MiB table
+      std::size_t const elements = 4U << 20;
+      std::ptrdiff_t const distance = 8;
+      std::vector<double> table((256U << 20) / sizeof(double), 1.0);
+      std::vector<std::uint32_t> indices(elements);
+      std::uniform_int_distribution<std::uint32_t> index(0U, static_cast<std::uint32_t>(table.size() - 1U));
+      for(auto &&i : indices) {
+        i = index(rng);
+      }
+
+      auto const entry = [&table](std::vector<std::uint32_t>::const_iterator const &it) -> void const * {
+        return &table[*it];
+      };
+      add(results, "index gather", elements, distance,
+          BestOf(3U, [&]() {
+            double sum = 0.0;
+            for(auto it = std::cbegin(indices); it != std::cend(indices); ++it) {
+              sum += table[*it];
+            }
+            sink = sum;
+          }),
+          BestOf(3U, [&]() {
+            double sum = 0.0;
+            for(auto it = make_prefetch_iterator(std::cbegin(indices), std::cend(indices), distance, entry);
+                it != std::cend(indices); ++it) {
+              sum += table[*it];
+            }
+            sink = sum;
+          }));
+    }
+  }
+} // namespace iterator_prefetch
+
+int main(int argc, char **argv)
+{
+  Results results;
+  work_queue::bench(results);
+  resource_pool::bench(results);
+  fire_and_dont_forget::bench(results);
+  print_unmangled::bench(results);
+  iterator_tiled::bench(results);
+  iterator_prefetch::bench(results);
+
+  if(argc > 1) {
+    std::ofstream ofs(argv[1]);
+    results.Write(ofs);
+    if(!ofs) {
+      std::cerr << "failed to write " << argv[1] << std::endl;
+      return 1;
+    }
+  } else {
+    results.Write(std::cout);
+  }
+
+  return 0;
+}
@@ -1,11 +1,18 @@
 #ifndef FIRE_AND_DONT_FORGET_H
 #define FIRE_AND_DONT_FORGET_H
 
+#include "trace_span.h" // for TraceSpan
+
+#include <atomic> // for std::atomic
 #include <cassert> // for assert
+#include <chrono> // for std::chrono::steady_clock
+#include <condition_variable> // for std::condition_variable
 #include <functional> // for std::invoke
+#include <memory> // for std::shared_ptr
 #include <mutex> // for std::mutex
 #include <thread> // for std::thread
 #include <unordered_map> // for std::unordered_map
+#include <vector> // for std::vector
 
 namespace fire_and_dont_forget_detail {
 
@@ -76,14 +83,42 @@ namespace fire_and_dont_forget_detail {
 class FireAndDontForget
 {
 public:
+  /// @brief  cooperative cancellation flag handed to work loads
+  ///         dispatched with DispatchStoppable
+  class StopToken
+  {
+    friend class FireAndDontForget;
+
+  public:
+    /// @return  true once RequestStop or Shutdown has been called
+    ///          after the work load was dispatched
+    bool IsStopRequested() const noexcept
+    {
+      return m_flag->load(std::memory_order_relaxed);
+    }
+
+  private:
+    explicit StopToken(std::shared_ptr<const std::atomic<bool>> flag)
+      : m_flag(std::move(flag))
+    {}
+
+  private:
+    std::shared_ptr<const std::atomic<bool>> m_flag;
+  };
+
+  /// create an empty handle storage
+  FireAndDontForget()
+    : m_state(std::make_shared<State>())
+  {}
+
   /// destructor blocking until all threads have joined
   ~FireAndDontForget()
   {
     // grab handles to local variable before waiting to avoid deadlock
-    decltype(m_handles) handles;
+    decltype(m_state->handles) handles;
     {
-      std::lock_guard<std::mutex> lock(m_mtx);
-      std::swap(handles, m_handles);
+      std::lock_guard<std::mutex> lock(m_state->mtx);
+      std::swap(handles, m_state->handles);
     }
 
     for(auto&& p : handles) {
@@ -98,34 +133,117 @@ public:
   template<typename Fn, typename... Args>
   void Dispatch(Fn&& fn, Args&&... args)
   {
-    std::lock_guard<std::mutex> lock(m_mtx);
+    std::lock_guard<std::mutex> lock(m_state->mtx);
 
     // start a new thread and store the handle
     // std::decay to handle an argument copy
-    m_handles.emplace(
+    m_state->handles.emplace(
           ToPair(
             std::thread(
               &FireAndDontForget::Run<std::decay_t<Fn>, std::decay_t<Args>...>,
-              this,
+              m_state,
               std::forward<Fn>(fn),
               std::forward<Args>(args)...)));
   }
 
+  /// @brief  dispatch a work load that can be asked to stop early
+  /// @param  fn  callable in the form of a function, member function or lambda
+  ///         taking a StopToken as its last argument
+  /// @param  args  callable arguments (may be non-copyable)
+  /// @note  the work load is expected to poll StopToken::IsStopRequested
+  template<typename Fn, typename... Args>
+  void DispatchStoppable(Fn&& fn, Args&&... args)
+  {
+    std::lock_guard<std::mutex> lock(m_state->mtx);
+
+    m_state->handles.emplace(
+          ToPair(
+            std::thread(
+              &FireAndDontForget::Run<std::decay_t<Fn>, std::decay_t<Args>..., StopToken>,
+              m_state,
+              std::forward<Fn>(fn),
+              std::forward<Args>(args)...,
+              StopToken(m_state->stopFlag))));
+  }
+
+  /// @brief  signal all work loads dispatched so far to stop
+  /// @note  does not block; work loads dispatched afterwards
+  ///        receive a fresh StopToken
+  void RequestStop()
+  {
+    std::lock_guard<std::mutex> lock(m_state->mtx);
+
+    m_state->stopFlag->store(true, std::memory_order_relaxed);
+    m_state->stopFlag = std::make_shared<std::atomic<bool>>(false);
+  }
+
+  /// @brief  request stop and wait for the remaining threads to join
+  /// @param  deadline  point in time to give up waiting
+  /// @return  ids of the threads that did not finish in time;
+  ///          these are detached and no longer waited for by the destructor
+  /// @note  detached work loads must not reference anything
+  ///        that is destroyed along with this instance
+  template<typename Clock, typename Duration>
+  std::vector<std::thread::id> Shutdown(
+    const std::chrono::time_point<Clock, Duration>& deadline)
+  {
+    RequestStop();
+
+    std::unique_lock<std::mutex> lock(m_state->mtx);
+    (void)m_state->cv.wait_until(lock, deadline,
+      [this]() -> bool {
+        return m_state->handles.empty();
+      });
+
+    // whatever is left has not finished in time
+    std::vector<std::thread::id> unfinished;
+    unfinished.reserve(m_state->handles.size());
+    for(auto&& p : m_state->handles) {
+      unfinished.push_back(p.first);
+      p.second.detach();
+    }
+    m_state->handles.clear();
+
+    return unfinished;
+  }
+
+  /// @brief  request stop and wait for the remaining threads to join
+  /// @param  timeout  duration to give up waiting after
+  /// @return  ids of the threads that did not finish in time
+  template<typename Rep, typename Period>
+  std::vector<std::thread::id> Shutdown(
+    const std::chrono::duration<Rep, Period>& timeout)
+  {
+    return Shutdown(std::chrono::steady_clock::now() + timeout);
+  }
+
 private:
   using Handles = std::unordered_map<std::thread::id, std::thread>;
 
+  /// state shared with the dispatched threads so that detached
+  /// threads may outlive the instance
+  struct State
+  {
+    std::mutex mtx;
+    std::condition_variable cv;
+    Handles handles;  // guarded by mtx
+    std::shared_ptr<std::atomic<bool>> stopFlag =
+      std::make_shared<std::atomic<bool>>(false);  // guarded by mtx
+  };
+
 private:
-  Handles::value_type ToPair(std::thread t)
+  static Handles::value_type ToPair(std::thread t)
   {
     auto id = t.get_id();
     return std::make_pair(std::move(id), std::move(t));
   }
 
   template<typename Fn, typename... Args>
-  void Run(Fn fn, Args... args)
+  static void Run(std::shared_ptr<State> state, Fn fn, Args... args)
   {
     // process work load and silently discard encountered exceptions
     try {
+      TraceSpan span("FireAndDontForget dispatch");
       (void)fire_and_dont_forget_detail::invoke(
             std::forward<Fn>(fn), std::forward<Args>(args)...);
     } catch(const std::exception&) {
@@ -135,27 +253,30 @@ private:
     }
 
     // remove thread handle from the storage to avoid bloat
-    RemoveMe();
+    RemoveMe(*state);
   }
 
-  void RemoveMe()
+  static void RemoveMe(State& state)
   {
-    std::lock_guard<std::mutex> lock(m_mtx);
+    {
+      std::lock_guard<std::mutex> lock(state.mtx);
 
-    // remove thread handle from the storage
-    const auto it = m_handles.find(std::this_thread::get_id());
-    if(it != std::end(m_handles)) {
-      it->second.detach();
-      m_handles.erase(it);
-    } else {
-      // cleared by destructor
-      assert(m_handles.empty());
+      // remove thread handle from the storage
+      const auto it = state.handles.find(std::this_thread::get_id());
+      if(it != std::end(state.handles)) {
+        it->second.detach();
+        state.handles.erase(it);
+      } else {
+        // cleared by destructor or detached by Shutdown
+      }
     }
+
+    // notify a waiting Shutdown
+    state.cv.notify_all();
   }
 
 private:
-  std::mutex m_mtx;
-  Handles m_handles;
+  std::shared_ptr<State> m_state;
 };
 
 #endif // FIRE_AND_DONT_FORGET_H
@@ -1,18 +1,256 @@
 #ifndef HELPER_H
 #define HELPER_H
 
-#include <utility>
+#include <array> // for std::array
+#include <cstddef> // for std::size_t
+#include <cstdint> // for std::uint64_t
+#include <stdexcept> // for std::invalid_argument
+#include <string_view> // for std::string_view
+#include <type_traits> // for std::is_integral
 
-template<typename T>
-bool IsAnyEqual(T&&) {
-  return false;
-}
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+# if defined(__cpp_lib_is_constant_evaluated) || defined(__GNUC__) || defined(__clang__) || (defined(_MSC_VER) && _MSC_VER >= 1925)
+#  include <emmintrin.h> // for _mm_cmpeq_epi32
+#  define HELPER_SIMD
+# endif
+#endif
+
+namespace helper_detail {
+
+#ifdef HELPER_SIMD
+  /// minimum number of candidates to compare with SIMD
+  constexpr std::size_t simdCandidates = 8U;
+
+  template<typename T, typename... Args>
+  constexpr bool isSimdComparable =
+    std::is_integral<T>::value &&
+    !std::is_same<T, bool>::value &&
+    (sizeof...(Args) >= simdCandidates) &&
+    (std::is_same<T, Args>::value && ...);
+
+  constexpr bool isConstantEvaluated() noexcept
+  {
+# if defined(__cpp_lib_is_constant_evaluated)
+    return std::is_constant_evaluated();
+# else
+    return __builtin_is_constant_evaluated();
+# endif
+  }
+
+  template<typename T>
+  __m128i broadcast(T value) noexcept
+  {
+    if constexpr(sizeof(T) == 1U) {
+      return _mm_set1_epi8(static_cast<char>(value));
+    } else if constexpr(sizeof(T) == 2U) {
+      return _mm_set1_epi16(static_cast<short>(value));
+    } else if constexpr(sizeof(T) == 4U) {
+      return _mm_set1_epi32(static_cast<int>(value));
+    } else {
+      return _mm_set1_epi64x(static_cast<long long>(value));
+    }
+  }
+
+  template<typename T>
+  __m128i compare(__m128i lhs, __m128i rhs) noexcept
+  {
+    if constexpr(sizeof(T) == 1U) {
+      return _mm_cmpeq_epi8(lhs, rhs);
+    } else if constexpr(sizeof(T) == 2U) {
+      return _mm_cmpeq_epi16(lhs, rhs);
+    } else if constexpr(sizeof(T) == 4U) {
+      return _mm_cmpeq_epi32(lhs, rhs);
+    } else {
+      // SSE2 lacks 64 bit compares; both 32 bit halves have to match
+      auto const eq = _mm_cmpeq_epi32(lhs, rhs);
+      return _mm_and_si128(eq, _mm_shuffle_epi32(eq, _MM_SHUFFLE(2, 3, 0, 1)));
+    }
+  }
+
+  /// compare value to all candidates without branching
+  template<typename T, std::size_t N>
+  bool isAnyEqualSimd(T value, std::array<T, N> const &candidates) noexcept
+  {
+    constexpr std::size_t lanes = sizeof(__m128i) / sizeof(T);
 
+    auto const needle = broadcast(value);
+    auto hits = _mm_setzero_si128();
+    std::size_t i = 0U;
+    for(; i + lanes <= N; i += lanes) {
+      auto const chunk = _mm_loadu_si128(reinterpret_cast<__m128i const *>(candidates.data() + i));
+      hits = _mm_or_si128(hits, compare<T>(needle, chunk));
+    }
+
+    bool found = (_mm_movemask_epi8(hits) != 0);
+    for(; i < N; ++i) {
+      found |= (value == candidates[i]);
+    }
+    return found;
+  }
+#endif // HELPER_SIMD
+
+  /// FNV-1a
+  constexpr std::uint64_t hash(std::string_view str) noexcept
+  {
+    std::uint64_t h = 14695981039346656037ULL;
+    for(auto c : str) {
+      h ^= static_cast<unsigned char>(c);
+      h *= 1099511628211ULL;
+    }
+    return h;
+  }
+
+  /// murmur3 finalizer spreading hash and seed over the slots
+  constexpr std::uint64_t mix(std::uint64_t h, std::uint32_t seed) noexcept
+  {
+    h += seed * 0x9E3779B97F4A7C15ULL;
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDULL;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ULL;
+    h ^= h >> 33;
+    return h;
+  }
+
+  constexpr std::size_t slotsFor(std::size_t n) noexcept
+  {
+    std::size_t slots = 1U;
+    while(slots < 2U * n) {
+      slots *= 2U;
+    }
+    return slots;
+  }
+
+} // namespace helper_detail
+
+/// @brief  check whether value equals any of the candidates
+/// @note  usable in constant expressions; integral candidates of the
+///        value's type are compared all at once with SIMD if there are many
 template<typename T, typename... Args>
-bool IsAnyEqual(T&& value, T&& first, Args&&... args) {
-  return ((value == first) ||
-          (IsAnyEqual(std::forward<T>(value), std::forward<Args>(args)...)));
+constexpr bool IsAnyEqual(T const &value, Args const &... args)
+{
+#ifdef HELPER_SIMD
+  if constexpr(helper_detail::isSimdComparable<T, Args...>) {
+    if(!helper_detail::isConstantEvaluated()) {
+      return helper_detail::isAnyEqualSimd(value, std::array<T, sizeof...(Args)>{{args...}});
+    }
+  }
+#endif // HELPER_SIMD
+  return (false || ... || (value == args));
 }
 
-#endif // HELPER_H
+/// @brief  perfect hash set of N strings built at compile time;
+///         a lookup hashes the string once and compares it to one candidate
+/// @note  use as
+///          constexpr auto methods = MakeStringSet("GET", "HEAD", "POST");
+///          if(methods.Contains(method)) {...}
+/// @note  the set refers to the candidates, e.g. string literals, without copying them
+template<std::size_t N>
+class StringSet
+{
+  static_assert(N > 0U, "StringSet requires candidates");
 
+public:
+  static constexpr std::size_t slots = helper_detail::slotsFor(N);
+
+  /// @throw  std::invalid_argument if the candidates contain duplicates
+  constexpr explicit StringSet(std::array<std::string_view, N> const &candidates)
+  {
+    // hash and displace: the candidates are distributed into N buckets,
+    // then each bucket, largest first, searches for a seed that maps all
+    // of its candidates to free slots
+    std::array<std::uint64_t, N> hashes{};
+    std::array<std::size_t, N> sizes{};
+    std::size_t maxSize = 0U;
+    for(std::size_t i = 0U; i < N; ++i) {
+      for(std::size_t j = 0U; j < i; ++j) {
+        if(candidates[i] == candidates[j]) {
+          throw std::invalid_argument("duplicate candidate");
+        }
+      }
+      hashes[i] = helper_detail::hash(candidates[i]);
+      auto const size = ++sizes[bucket(hashes[i])];
+      maxSize = (size > maxSize ? size : maxSize);
+    }
+
+    for(auto size = maxSize; size > 0U; --size) {
+      for(std::size_t b = 0U; b < N; ++b) {
+        if(sizes[b] == size) {
+          place(candidates, hashes, b);
+        }
+      }
+    }
+  }
+
+  constexpr bool Contains(std::string_view str) const noexcept
+  {
+    auto const h = helper_detail::hash(str);
+    auto const s = slot(h, m_seeds[bucket(h)]);
+    return m_used[s] && (m_table[s] == str);
+  }
+
+  static constexpr std::size_t Size() noexcept
+  {
+    return N;
+  }
+
+private:
+  static constexpr std::size_t bucket(std::uint64_t h) noexcept
+  {
+    return static_cast<std::size_t>((helper_detail::mix(h, 0U) >> 32) % N);
+  }
+
+  static constexpr std::size_t slot(std::uint64_t h, std::uint32_t seed) noexcept
+  {
+    return static_cast<std::size_t>(helper_detail::mix(h, seed) & (slots - 1U));
+  }
+
+  constexpr void place(
+    std::array<std::string_view, N> const &candidates,
+    std::array<std::uint64_t, N> const &hashes,
+    std::size_t b)
+  {
+    std::array<std::size_t, N> members{};
+    std::size_t count = 0U;
+    for(std::size_t i = 0U; i < N; ++i) {
+      if(bucket(hashes[i]) == b) {
+        members[count++] = i;
+      }
+    }
+
+    for(std::uint32_t seed = 0U;; ++seed) {
+      bool fits = true;
+      for(std::size_t i = 0U; fits && (i < count); ++i) {
+        auto const s = slot(hashes[members[i]], seed);
+        fits = !m_used[s];
+        for(std::size_t j = 0U; fits && (j < i); ++j) {
+          fits = (s != slot(hashes[members[j]], seed));
+        }
+      }
+
+      if(fits) {
+        m_seeds[b] = seed;
+        for(std::size_t i = 0U; i < count; ++i) {
+          auto const s = slot(hashes[members[i]], seed);
+          m_table[s] = candidates[members[i]];
+          m_used[s] = true;
+        }
+        return;
+      }
+    }
+  }
+
+private:
+  std::array<std::uint32_t, N> m_seeds{};  // per bucket
+  std::array<std::string_view, slots> m_table{};
+  std::array<bool, slots> m_used{};
+};
+
+template<typename... Strings>
+constexpr StringSet<sizeof...(Strings)> MakeStringSet(Strings const &... candidates)
+{
+  return StringSet<sizeof...(Strings)>(
+    std::array<std::string_view, sizeof...(Strings)>{{std::string_view(candidates)...}});
+}
+
+#endif // HELPER_H
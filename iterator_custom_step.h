@@ -2,7 +2,8 @@
 
 #include <cassert>
 
-// TODO past-the-'past-the-end' iterators are considered UB
+// TODO past-the-'past-the-end' iterators are considered UB;
+//      strided_view in iterator_strided_view.h clamps its end instead
 template<typename wrapped_iterator>
 struct custom_step_iterator : wrapped_iterator
 {
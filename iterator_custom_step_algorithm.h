@@ -0,0 +1,461 @@
+#pragma once
+
+#include "iterator_custom_step.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+# define CUSTOM_STEP_SIMD 1
+# include <immintrin.h>
+#else
+# define CUSTOM_STEP_SIMD 0
+#endif
+
+// strided algorithms for custom_step_iterator over contiguous data,
+// e.g. to (de)interleave one channel of a sample buffer;
+// elements of 4 and 8 bytes use SSE/AVX2 kernels picked at runtime,
+// anything else falls back to plain loops
+
+/// whether wrapped_iterator points into contiguous storage;
+/// specialize for further iterator types
+template<typename wrapped_iterator, typename = void>
+struct is_contiguous_iterator : std::false_type {};
+
+template<typename T>
+struct is_contiguous_iterator<T *> : std::true_type {};
+
+namespace custom_step_detail {
+
+  /// only instantiated for value types a container can hold
+  template<typename wrapped_iterator, typename T>
+  struct is_container_iterator : std::integral_constant<bool, false
+    || std::is_same<wrapped_iterator, typename std::vector<T>::iterator>::value
+    || std::is_same<wrapped_iterator, typename std::vector<T>::const_iterator>::value
+    || std::is_same<wrapped_iterator, typename std::basic_string<T>::iterator>::value
+    || std::is_same<wrapped_iterator, typename std::basic_string<T>::const_iterator>::value> {};
+
+} // namespace custom_step_detail
+
+// output iterators like std::back_insert_iterator have a void value_type
+template<typename wrapped_iterator>
+struct is_contiguous_iterator<wrapped_iterator, std::enable_if_t<std::conjunction<
+  std::negation<std::is_pointer<wrapped_iterator>>,
+  std::is_object<typename std::iterator_traits<wrapped_iterator>::value_type>,
+  std::negation<std::is_same<typename std::iterator_traits<wrapped_iterator>::value_type, bool>>,
+  custom_step_detail::is_container_iterator<wrapped_iterator,
+    typename std::iterator_traits<wrapped_iterator>::value_type>>::value>>
+  : std::true_type {};
+
+namespace custom_step_detail {
+
+  template<typename T>
+  using is_simd_element = std::integral_constant<bool,
+    std::is_trivially_copyable<T>::value &&
+    ((sizeof(T) == 4U) || (sizeof(T) == 8U))>;
+
+  template<typename wrapped_iterator>
+  auto to_pointer(wrapped_iterator it)
+  {
+    return std::addressof(*it);
+  }
+
+#if CUSTOM_STEP_SIMD
+
+  inline bool has_avx2()
+  {
+    static bool const avx2 = __builtin_cpu_supports("avx2");
+    return avx2;
+  }
+
+  // gather count elements at src, src + step, ... into dst
+
+  __attribute__((target("avx2")))
+  inline std::size_t gather32_avx2(void const *src, std::ptrdiff_t step, std::size_t count, void *dst)
+  {
+    auto const s = static_cast<int>(step);
+    auto const vindex = _mm256_setr_epi32(0, s, 2 * s, 3 * s, 4 * s, 5 * s, 6 * s, 7 * s);
+    auto in = static_cast<int const *>(src);
+    auto out = static_cast<int *>(dst);
+
+    std::size_t i = 0U;
+    for(; i + 8U <= count; i += 8U, in += 8 * step, out += 8) {
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(out), _mm256_i32gather_epi32(in, vindex, 4));
+    }
+    return i;
+  }
+
+  __attribute__((target("avx2")))
+  inline std::size_t gather64_avx2(void const *src, std::ptrdiff_t step, std::size_t count, void *dst)
+  {
+    auto const s = static_cast<int>(step);
+    auto const vindex = _mm_setr_epi32(0, s, 2 * s, 3 * s);
+    auto in = static_cast<long long const *>(src);
+    auto out = static_cast<long long *>(dst);
+
+    std::size_t i = 0U;
+    for(; i + 4U <= count; i += 4U, in += 4 * step, out += 4) {
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(out), _mm256_i32gather_epi64(in, vindex, 8));
+    }
+    return i;
+  }
+
+  // every other element by shuffling; SSE2 is available on every x86-64
+  inline std::size_t gather32_step2_sse(void const *src, std::size_t count, void *dst)
+  {
+    auto in = static_cast<float const *>(src);
+    auto out = static_cast<float *>(dst);
+
+    // each group loads in[0..7] but needs in[6] at most, so the last
+    // group is left to the scalar tail not to read past the data
+    std::size_t i = 0U;
+    for(; i + 4U < count; i += 4U, in += 8, out += 4) {
+      auto const lo = _mm_loadu_ps(in);
+      auto const hi = _mm_loadu_ps(in + 4);
+      _mm_storeu_ps(out, _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0)));
+    }
+    return i;
+  }
+
+  /// lane permutations and store masks for scattering 8 values of 32 bits
+  /// to every step-th element, spread over step vectors
+  struct scatter32_tables
+  {
+    explicit scatter32_tables(std::ptrdiff_t step)
+    {
+      for(std::ptrdiff_t k = 0; k < step; ++k) {
+        for(int l = 0; l < 8; ++l) {
+          auto const e = 8 * k + l;
+          auto const hit = (e % step == 0);
+          index[k][l] = (hit ? static_cast<int>(e / step) : 0);
+          mask[k][l] = (hit ? -1 : 0);
+        }
+      }
+    }
+
+    alignas(32) int index[8][8];
+    alignas(32) int mask[8][8];
+  };
+
+  /// scatter count values to dst, dst + step, ...; value is broadcast if src is null
+  __attribute__((target("avx2")))
+  inline std::size_t scatter32_avx2(void const *src, std::uint32_t value,
+                                    void *dst, std::ptrdiff_t step, std::size_t count)
+  {
+    scatter32_tables const tables(step);
+    auto in = static_cast<int const *>(src);
+    auto out = static_cast<int *>(dst);
+    auto const broadcast = _mm256_set1_epi32(static_cast<int>(value));
+
+    std::size_t i = 0U;
+    for(; i + 8U <= count; i += 8U, out += 8 * step) {
+      __m256i values = broadcast;
+      if(in) {
+        values = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(in + i));
+      }
+      for(std::ptrdiff_t k = 0; k < step; ++k) {
+        auto const index = _mm256_load_si256(reinterpret_cast<__m256i const *>(tables.index[k]));
+        auto const mask = _mm256_load_si256(reinterpret_cast<__m256i const *>(tables.mask[k]));
+        _mm256_maskstore_epi32(out + 8 * k, mask, _mm256_permutevar8x32_epi32(values, index));
+      }
+    }
+    return i;
+  }
+
+  __attribute__((target("avx2")))
+  inline float reduce_float_avx2(float const *src, std::ptrdiff_t step, std::size_t count, std::size_t &done)
+  {
+    auto const s = static_cast<int>(step);
+    auto const vindex = _mm256_setr_epi32(0, s, 2 * s, 3 * s, 4 * s, 5 * s, 6 * s, 7 * s);
+    auto sum = _mm256_setzero_ps();
+
+    std::size_t i = 0U;
+    for(; i + 8U <= count; i += 8U, src += 8 * step) {
+      sum = _mm256_add_ps(sum, _mm256_i32gather_ps(src, vindex, 4));
+    }
+    done = i;
+
+    alignas(32) float lanes[8];
+    _mm256_store_ps(lanes, sum);
+    return ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) +
+           ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]));
+  }
+
+  __attribute__((target("avx2")))
+  inline double reduce_double_avx2(double const *src, std::ptrdiff_t step, std::size_t count, std::size_t &done)
+  {
+    auto const s = static_cast<int>(step);
+    auto const vindex = _mm_setr_epi32(0, s, 2 * s, 3 * s);
+    auto sum = _mm256_setzero_pd();
+
+    std::size_t i = 0U;
+    for(; i + 4U <= count; i += 4U, src += 4 * step) {
+      sum = _mm256_add_pd(sum, _mm256_i32gather_pd(src, vindex, 8));
+    }
+    done = i;
+
+    alignas(32) double lanes[4];
+    _mm256_store_pd(lanes, sum);
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+  }
+
+  __attribute__((target("avx2")))
+  inline std::uint32_t reduce_int32_avx2(std::uint32_t const *src, std::ptrdiff_t step, std::size_t count, std::size_t &done)
+  {
+    auto const s = static_cast<int>(step);
+    auto const vindex = _mm256_setr_epi32(0, s, 2 * s, 3 * s, 4 * s, 5 * s, 6 * s, 7 * s);
+    auto sum = _mm256_setzero_si256();
+
+    std::size_t i = 0U;
+    for(; i + 8U <= count; i += 8U, src += 8 * step) {
+      sum = _mm256_add_epi32(sum, _mm256_i32gather_epi32(reinterpret_cast<int const *>(src), vindex, 4));
+    }
+    done = i;
+
+    alignas(32) std::uint32_t lanes[8];
+    _mm256_store_si256(reinterpret_cast<__m256i *>(lanes), sum);
+    std::uint32_t total = 0U;
+    for(auto lane : lanes) {
+      total += lane;
+    }
+    return total;
+  }
+
+#endif // CUSTOM_STEP_SIMD
+
+  /// gathers should not be used for strides exceeding the 32 bit lane indices
+  inline bool is_simd_step(std::ptrdiff_t step)
+  {
+    return (step > 0) && (step <= (1 << 24));
+  }
+
+  /// copy count elements at src, src + step, ... to contiguous dst
+  template<typename T>
+  void gather(T const *src, std::ptrdiff_t step, std::size_t count, T *dst)
+  {
+    std::size_t done = 0U;
+#if CUSTOM_STEP_SIMD
+    if(is_simd_element<T>::value && is_simd_step(step)) {
+      if(has_avx2()) {
+        done = (sizeof(T) == 4U ?
+                gather32_avx2(src, step, count, dst) :
+                gather64_avx2(src, step, count, dst));
+      } else if((sizeof(T) == 4U) && (step == 2)) {
+        done = gather32_step2_sse(src, count, dst);
+      }
+    }
+#endif // CUSTOM_STEP_SIMD
+    for(src += static_cast<std::ptrdiff_t>(done) * step; done < count; ++done, src += step) {
+      dst[done] = *src;
+    }
+  }
+
+  /// copy count elements of contiguous src, or value if src is null,
+  /// to dst, dst + step, ...
+  template<typename T>
+  void scatter(T const *src, T const &value, T *dst, std::ptrdiff_t step, std::size_t count)
+  {
+    std::size_t done = 0U;
+#if CUSTOM_STEP_SIMD
+    if(is_simd_element<T>::value && (sizeof(T) == 4U) &&
+       (step >= 2) && (step <= 8) && has_avx2()) {
+      std::uint32_t bits = 0U;
+      std::memcpy(&bits, &value, sizeof(bits));
+      done = scatter32_avx2(src, bits, dst, step, count);
+    }
+#endif // CUSTOM_STEP_SIMD
+    for(dst += static_cast<std::ptrdiff_t>(done) * step; done < count; ++done, dst += step) {
+      *dst = (src ? src[done] : value);
+    }
+  }
+
+  template<typename T>
+  T reduce(T const *src, std::ptrdiff_t step, std::size_t count, T init)
+  {
+    std::size_t done = 0U;
+#if CUSTOM_STEP_SIMD
+    if(is_simd_step(step) && has_avx2()) {
+      if constexpr(std::is_same<T, float>::value) {
+        init += reduce_float_avx2(src, step, count, done);
+      } else if constexpr(std::is_same<T, double>::value) {
+        init += reduce_double_avx2(src, step, count, done);
+      } else if constexpr(std::is_integral<T>::value && (sizeof(T) == 4U)) {
+        // two's complement wrap-around like the unsigned sum
+        init = static_cast<T>(static_cast<std::uint32_t>(init) +
+          reduce_int32_avx2(reinterpret_cast<std::uint32_t const *>(src), step, count, done));
+      }
+    }
+#endif // CUSTOM_STEP_SIMD
+    for(src += static_cast<std::ptrdiff_t>(done) * step; done < count; ++done, src += step) {
+      init += *src;
+    }
+    return init;
+  }
+
+  template<typename wrapped_iterator>
+  using value_t = typename std::iterator_traits<wrapped_iterator>::value_type;
+
+  template<typename wrapped_iterator>
+  using is_fast = std::integral_constant<bool,
+    is_contiguous_iterator<wrapped_iterator>::value &&
+    is_simd_element<value_t<wrapped_iterator>>::value>;
+
+  template<typename out_iterator, typename T>
+  using is_fast_output = std::integral_constant<bool,
+    is_contiguous_iterator<out_iterator>::value &&
+    std::is_same<typename std::iterator_traits<out_iterator>::value_type, T>::value>;
+
+  /// elements per chunk when going through a stack buffer
+  constexpr std::size_t chunk = 256U;
+
+} // namespace custom_step_detail
+
+/// @brief  copy the strided elements to a contiguous range, i.e. deinterleave
+/// @return  output iterator past the last element copied
+template<typename wrapped_iterator, typename out_iterator>
+out_iterator strided_copy(
+  custom_step_iterator<wrapped_iterator> first,
+  custom_step_iterator<wrapped_iterator> last,
+  out_iterator out)
+{
+  using namespace custom_step_detail;
+  using T = value_t<wrapped_iterator>;
+
+  if constexpr(is_fast<wrapped_iterator>::value) {
+    auto const count = static_cast<std::size_t>(last - first);
+    if(count == 0U) {
+      return out;
+    }
+    auto src = to_pointer(first.base());
+
+    if constexpr(is_fast_output<out_iterator, T>::value) {
+      gather(src, first.step, count, to_pointer(out));
+      return out + static_cast<std::ptrdiff_t>(count);
+    } else {
+      T buffer[chunk];
+      for(std::size_t done = 0U; done < count; ) {
+        auto const n = std::min(chunk, count - done);
+        gather(src, first.step, n, buffer);
+        out = std::copy(buffer, buffer + n, out);
+        src += static_cast<std::ptrdiff_t>(n) * first.step;
+        done += n;
+      }
+      return out;
+    }
+  } else {
+    return std::copy(first, last, out);
+  }
+}
+
+/// @brief  copy a contiguous range to the strided elements, i.e. interleave
+/// @return  strided iterator past the last element written
+template<typename in_iterator, typename wrapped_iterator>
+custom_step_iterator<wrapped_iterator> strided_interleave(
+  in_iterator first,
+  in_iterator last,
+  custom_step_iterator<wrapped_iterator> out)
+{
+  using namespace custom_step_detail;
+  using T = value_t<wrapped_iterator>;
+
+  if constexpr(is_fast<wrapped_iterator>::value &&
+               is_fast_output<in_iterator, T>::value) {
+    auto const count = static_cast<std::size_t>(std::distance(first, last));
+    if(count > 0U) {
+      scatter(to_pointer(first), T(), to_pointer(out.base()), out.step, count);
+      out += static_cast<std::ptrdiff_t>(count);
+    }
+    return out;
+  } else {
+    for(; first != last; ++first, ++out) {
+      *out = *first;
+    }
+    return out;
+  }
+}
+
+/// assign value to the strided elements
+template<typename wrapped_iterator, typename T>
+void strided_fill(
+  custom_step_iterator<wrapped_iterator> first,
+  custom_step_iterator<wrapped_iterator> last,
+  T const &value)
+{
+  using namespace custom_step_detail;
+  using V = value_t<wrapped_iterator>;
+
+  if constexpr(is_fast<wrapped_iterator>::value) {
+    auto const count = static_cast<std::size_t>(last - first);
+    if(count > 0U) {
+      scatter<V>(nullptr, static_cast<V>(value), to_pointer(first.base()), first.step, count);
+    }
+  } else {
+    std::fill(first, last, value);
+  }
+}
+
+/// @brief  transform the strided elements to a contiguous range;
+///         elements are deinterleaved chunk-wise first so that
+///         the compiler may vectorize op
+template<typename wrapped_iterator, typename out_iterator, typename unary_operation>
+out_iterator strided_transform(
+  custom_step_iterator<wrapped_iterator> first,
+  custom_step_iterator<wrapped_iterator> last,
+  out_iterator out,
+  unary_operation op)
+{
+  using namespace custom_step_detail;
+  using T = value_t<wrapped_iterator>;
+
+  if constexpr(is_fast<wrapped_iterator>::value) {
+    auto const count = static_cast<std::size_t>(last - first);
+    if(count == 0U) {
+      return out;
+    }
+    auto src = to_pointer(first.base());
+
+    T buffer[chunk];
+    for(std::size_t done = 0U; done < count; ) {
+      auto const n = std::min(chunk, count - done);
+      gather(src, first.step, n, buffer);
+      out = std::transform(buffer, buffer + n, out, op);
+      src += static_cast<std::ptrdiff_t>(n) * first.step;
+      done += n;
+    }
+    return out;
+  } else {
+    return std::transform(first, last, out, op);
+  }
+}
+
+/// @brief  sum the strided elements
+/// @note  like std::reduce, floating point sums may be reordered
+template<typename wrapped_iterator, typename T>
+T strided_reduce(
+  custom_step_iterator<wrapped_iterator> first,
+  custom_step_iterator<wrapped_iterator> last,
+  T init)
+{
+  using namespace custom_step_detail;
+
+  if constexpr(is_fast<wrapped_iterator>::value &&
+               std::is_same<value_t<wrapped_iterator>, T>::value) {
+    auto const count = static_cast<std::size_t>(last - first);
+    if(count == 0U) {
+      return init;
+    }
+    return reduce(to_pointer(first.base()), first.step, count, init);
+  } else {
+    for(; first != last; ++first) {
+      init = init + *first;
+    }
+    return init;
+  }
+}
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <array>
+#include <cstddef>
 #include <deque>
 #include <stdexcept>
 
@@ -83,3 +85,167 @@ make_dance_dance_iterator(wrapped_iterator it, Steps&&... steps)
     std::deque<difference_type>{
       static_cast<difference_type>(steps)...}};
 }
+
+// dance_dance_iterator variants cycling through a fixed step pattern;
+// the pattern position is a cursor index, so copies and comparisons
+// are O(1) and do not allocate; an end iterator must carry the cursor
+// that the sequence reaches at its position
+
+template<typename wrapped_iterator, auto... steps>
+struct dance_pattern_iterator : wrapped_iterator
+{
+  static_assert(sizeof...(steps) > 0, "empty step pattern");
+
+  using iterator_category = std::bidirectional_iterator_tag;
+  using typename wrapped_iterator::difference_type;
+
+  static constexpr difference_type pattern[] = {
+    static_cast<difference_type>(steps)...};
+  static constexpr std::size_t pattern_size = sizeof...(steps);
+
+  std::size_t cursor;
+
+  const wrapped_iterator& base() const noexcept
+  {
+    return static_cast<const wrapped_iterator&>(*this);
+  }
+
+  wrapped_iterator& operator++() noexcept
+  {
+    static_cast<wrapped_iterator&>(*this) += pattern[cursor];
+    cursor = (cursor + 1 == pattern_size ? 0 : cursor + 1);
+    return *this;
+  }
+
+  wrapped_iterator operator++(int) noexcept
+  {
+    auto tmp = *this;
+    ++*this;
+    return tmp;
+  }
+
+  wrapped_iterator& operator--() noexcept
+  {
+    cursor = (cursor == 0 ? pattern_size - 1 : cursor - 1);
+    static_cast<wrapped_iterator&>(*this) -= pattern[cursor];
+    return *this;
+  }
+
+  wrapped_iterator operator--(int) noexcept
+  {
+    auto tmp = *this;
+    --*this;
+    return tmp;
+  }
+
+  friend bool operator==(
+    const dance_pattern_iterator& lhs,
+    const dance_pattern_iterator& rhs) noexcept
+  {
+    return (lhs.base() == rhs.base()) && (lhs.cursor == rhs.cursor);
+  }
+
+  friend bool operator!=(
+    const dance_pattern_iterator& lhs,
+    const dance_pattern_iterator& rhs) noexcept
+  {
+    return !(lhs == rhs);
+  }
+};
+
+template<typename wrapped_iterator, std::size_t N>
+struct dance_cycle_iterator : wrapped_iterator
+{
+  static_assert(N > 0, "empty step pattern");
+
+  using iterator_category = std::bidirectional_iterator_tag;
+  using typename wrapped_iterator::difference_type;
+
+  std::array<difference_type, N> steps;
+  std::size_t cursor;
+
+  const wrapped_iterator& base() const noexcept
+  {
+    return static_cast<const wrapped_iterator&>(*this);
+  }
+
+  wrapped_iterator& operator++() noexcept
+  {
+    static_cast<wrapped_iterator&>(*this) += steps[cursor];
+    cursor = (cursor + 1 == N ? 0 : cursor + 1);
+    return *this;
+  }
+
+  wrapped_iterator operator++(int) noexcept
+  {
+    auto tmp = *this;
+    ++*this;
+    return tmp;
+  }
+
+  wrapped_iterator& operator--() noexcept
+  {
+    cursor = (cursor == 0 ? N - 1 : cursor - 1);
+    static_cast<wrapped_iterator&>(*this) -= steps[cursor];
+    return *this;
+  }
+
+  wrapped_iterator operator--(int) noexcept
+  {
+    auto tmp = *this;
+    --*this;
+    return tmp;
+  }
+
+  /// @note  iterators of the same sequence share the step pattern,
+  ///        so it is not compared
+  friend bool operator==(
+    const dance_cycle_iterator& lhs,
+    const dance_cycle_iterator& rhs) noexcept
+  {
+    return (lhs.base() == rhs.base()) && (lhs.cursor == rhs.cursor);
+  }
+
+  friend bool operator!=(
+    const dance_cycle_iterator& lhs,
+    const dance_cycle_iterator& rhs) noexcept
+  {
+    return !(lhs == rhs);
+  }
+};
+
+/// @param  cursor  pattern position at it; an end iterator n increments
+///         after a begin at cursor 0 needs cursor n % sizeof...(steps)
+template<auto... steps, typename wrapped_iterator>
+dance_pattern_iterator<wrapped_iterator, steps...>
+make_dance_pattern_iterator(wrapped_iterator it, std::size_t cursor = 0)
+{
+  return dance_pattern_iterator<wrapped_iterator, steps...>{it, cursor};
+}
+
+template<typename wrapped_iterator, typename... Steps>
+dance_cycle_iterator<wrapped_iterator, sizeof...(Steps)>
+make_dance_cycle_iterator(wrapped_iterator it, Steps&&... steps)
+{
+  using difference_type = typename wrapped_iterator::difference_type;
+
+  return dance_cycle_iterator<wrapped_iterator, sizeof...(Steps)>{it,
+    {{static_cast<difference_type>(steps)...}}, 0};
+}
+
+/// @brief  use as make_dance_cycle_iterator(it, {1, 2}, cursor)
+/// @param  cursor  pattern position at it; an end iterator n increments
+///         after a begin at cursor 0 needs cursor n % N
+template<typename wrapped_iterator, std::size_t N>
+dance_cycle_iterator<wrapped_iterator, N>
+make_dance_cycle_iterator(
+  wrapped_iterator it,
+  const typename wrapped_iterator::difference_type (&steps)[N],
+  std::size_t cursor = 0)
+{
+  dance_cycle_iterator<wrapped_iterator, N> result{it, {}, cursor};
+  for(std::size_t i = 0; i < N; ++i) {
+    result.steps[i] = steps[i];
+  }
+  return result;
+}
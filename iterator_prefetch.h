@@ -0,0 +1,160 @@
+#pragma once
+
+#include <iterator>
+#include <memory>
+#include <type_traits>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+# include <xmmintrin.h>
+#endif
+
+// prefetch the element a distance ahead of the current one while iterating,
+// so the memory access overlaps with the work on the current elements;
+// pays off on working sets beyond the last level cache with per-element
+// accesses the hardware prefetcher cannot predict, e.g. large strides or nodes
+//
+// compose with the other wrappers from the inside, e.g.
+//   make_preserve_iterator(make_prefetch_iterator(list.begin(), list.end(), 8))
+
+namespace prefetch_detail {
+
+  /// default projection prefetching the element itself
+  struct element
+  {
+    template<typename iterator>
+    const void* operator()(const iterator& it) const noexcept
+    {
+      return std::addressof(*it);
+    }
+  };
+
+  inline void prefetch(const void* addr) noexcept
+  {
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(addr);
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    _mm_prefetch(static_cast<const char*>(addr), _MM_HINT_T0);
+#else
+    (void)addr;
+#endif
+  }
+
+  template<typename iterator>
+  constexpr bool is_random_access = std::is_base_of<
+    std::random_access_iterator_tag,
+    typename std::iterator_traits<iterator>::iterator_category>::value;
+
+} // namespace prefetch_detail
+
+/// @brief  prefetches the element at a fixed distance ahead on increment
+/// @note  the projection maps an iterator to the address to prefetch,
+///        e.g. the payload an element points to or indexes
+template<typename wrapped_iterator, typename projection = prefetch_detail::element>
+struct prefetch_iterator : wrapped_iterator
+{
+  using typename wrapped_iterator::difference_type;
+
+  wrapped_iterator last;
+  difference_type distance;
+  projection proj;
+
+  const wrapped_iterator& base() const noexcept
+  {
+    return static_cast<const wrapped_iterator&>(*this);
+  }
+
+  wrapped_iterator& operator++() noexcept
+  {
+    ++static_cast<wrapped_iterator&>(*this);
+    prefetch();
+    return *this;
+  }
+
+  wrapped_iterator operator++(int) noexcept
+  {
+    auto tmp = *this;
+    ++static_cast<wrapped_iterator&>(*this);
+    prefetch();
+    return tmp;
+  }
+
+private:
+  void prefetch() const noexcept
+  {
+    // never form an iterator beyond last
+    if(last - base() > distance) {
+      prefetch_detail::prefetch(proj(std::next(base(), distance)));
+    }
+  }
+};
+
+/// @brief  prefetches the element a wrapped copy of the iterator
+///         is advanced to ahead of it on increment
+/// @note  for node-based containers whose iterators can only be walked;
+///        as the lookahead touches the nodes anyway, this pays off when
+///        the projection leads to data outside of the nodes
+template<typename wrapped_iterator, typename projection = prefetch_detail::element>
+struct lookahead_prefetch_iterator : wrapped_iterator
+{
+  using iterator_category = std::forward_iterator_tag;
+
+  wrapped_iterator ahead;
+  wrapped_iterator last;
+  projection proj;
+
+  const wrapped_iterator& base() const noexcept
+  {
+    return static_cast<const wrapped_iterator&>(*this);
+  }
+
+  wrapped_iterator& operator++()
+  {
+    ++static_cast<wrapped_iterator&>(*this);
+    advance();
+    return *this;
+  }
+
+  wrapped_iterator operator++(int)
+  {
+    auto tmp = *this;
+    ++static_cast<wrapped_iterator&>(*this);
+    advance();
+    return tmp;
+  }
+
+  // the lookahead only walks forward
+  wrapped_iterator& operator--() = delete;
+  wrapped_iterator operator--(int) = delete;
+
+private:
+  void advance()
+  {
+    if(ahead != last && ++ahead != last) {
+      prefetch_detail::prefetch(proj(ahead));
+    }
+  }
+};
+
+/// @return  prefetch_iterator for random access iterators,
+///          lookahead_prefetch_iterator otherwise
+template<typename wrapped_iterator, typename projection = prefetch_detail::element>
+std::conditional_t<
+  prefetch_detail::is_random_access<wrapped_iterator>,
+  prefetch_iterator<wrapped_iterator, projection>,
+  lookahead_prefetch_iterator<wrapped_iterator, projection>>
+make_prefetch_iterator(
+  wrapped_iterator it,
+  wrapped_iterator last,
+  typename std::iterator_traits<wrapped_iterator>::difference_type distance,
+  projection proj = projection())
+{
+  if constexpr(prefetch_detail::is_random_access<wrapped_iterator>) {
+    return prefetch_iterator<wrapped_iterator, projection>{it, last, distance, proj};
+  } else {
+    auto ahead = it;
+    for(; (distance > 0) && (ahead != last); --distance) {
+      ++ahead;
+    }
+    return lookahead_prefetch_iterator<wrapped_iterator, projection>{it, ahead, last, proj};
+  }
+}
@@ -0,0 +1,239 @@
+#pragma once
+
+#if __cplusplus >= 202002L
+
+#include <cassert>
+#include <compare>
+#include <iterator>
+#include <ranges>
+#include <type_traits>
+#include <utility>
+
+// strided_view addresses the element at index * step of the underlying
+// range only when dereferenced, so unlike custom_step_iterator it never
+// forms iterators beyond the underlying range's end; the range length need
+// not be a multiple of the step
+
+template<std::ranges::view V>
+  requires std::ranges::random_access_range<V> && std::ranges::sized_range<V>
+class strided_view : public std::ranges::view_interface<strided_view<V>>
+{
+  template<bool is_const>
+  class iterator;
+
+public:
+  using difference_type = std::ranges::range_difference_t<V>;
+
+  strided_view() requires std::default_initializable<V> = default;
+
+  constexpr strided_view(V base, difference_type step)
+    : m_base(std::move(base))
+    , m_step(step)
+  {
+    assert(step > 0);
+  }
+
+  constexpr V base() const & requires std::copy_constructible<V>
+  {
+    return m_base;
+  }
+
+  constexpr V base() &&
+  {
+    return std::move(m_base);
+  }
+
+  constexpr difference_type step() const noexcept
+  {
+    return m_step;
+  }
+
+  constexpr auto begin()
+  {
+    return iterator<false>(std::ranges::begin(m_base), m_step, 0);
+  }
+
+  constexpr auto begin() const
+    requires std::ranges::random_access_range<V const> && std::ranges::sized_range<V const>
+  {
+    return iterator<true>(std::ranges::begin(m_base), m_step, 0);
+  }
+
+  constexpr auto end()
+  {
+    return iterator<false>(std::ranges::begin(m_base), m_step, count());
+  }
+
+  constexpr auto end() const
+    requires std::ranges::random_access_range<V const> && std::ranges::sized_range<V const>
+  {
+    return iterator<true>(std::ranges::begin(m_base), m_step, count());
+  }
+
+  constexpr auto size() const
+  {
+    return static_cast<std::ranges::range_size_t<V>>(count());
+  }
+
+private:
+  /// number of strided elements, i.e. the clamped end index
+  constexpr difference_type count() const
+  {
+    auto const n = static_cast<difference_type>(std::ranges::size(m_base));
+    return (n + m_step - 1) / m_step;
+  }
+
+private:
+  V m_base = V();
+  difference_type m_step = 1;
+};
+
+template<std::ranges::view V>
+  requires std::ranges::random_access_range<V> && std::ranges::sized_range<V>
+template<bool is_const>
+class strided_view<V>::iterator
+{
+  using base_type = std::conditional_t<is_const, V const, V>;
+  using base_iterator = std::ranges::iterator_t<base_type>;
+
+public:
+  using iterator_concept = std::random_access_iterator_tag;
+  using value_type = std::ranges::range_value_t<base_type>;
+  using difference_type = std::ranges::range_difference_t<base_type>;
+  using reference = std::ranges::range_reference_t<base_type>;
+
+  // legacy iterator category for e.g. the std::execution algorithms
+  using iterator_category = std::conditional_t<
+    std::is_reference_v<reference>,
+    std::random_access_iterator_tag,
+    std::input_iterator_tag>;
+
+  iterator() = default;
+
+  constexpr iterator(base_iterator first, difference_type step, difference_type index)
+    : m_first(std::move(first))
+    , m_step(step)
+    , m_index(index)
+  {}
+
+  /// conversion from mutable to const iterator
+  constexpr iterator(iterator<!is_const> other)
+    requires is_const && std::convertible_to<std::ranges::iterator_t<V>, base_iterator>
+    : m_first(std::move(other.m_first))
+    , m_step(other.m_step)
+    , m_index(other.m_index)
+  {}
+
+  constexpr reference operator*() const
+  {
+    return m_first[m_index * m_step];
+  }
+
+  constexpr reference operator[](difference_type n) const
+  {
+    return m_first[(m_index + n) * m_step];
+  }
+
+  constexpr iterator &operator++()
+  {
+    ++m_index;
+    return *this;
+  }
+
+  constexpr iterator operator++(int)
+  {
+    auto tmp = *this;
+    ++m_index;
+    return tmp;
+  }
+
+  constexpr iterator &operator--()
+  {
+    --m_index;
+    return *this;
+  }
+
+  constexpr iterator operator--(int)
+  {
+    auto tmp = *this;
+    --m_index;
+    return tmp;
+  }
+
+  constexpr iterator &operator+=(difference_type n)
+  {
+    m_index += n;
+    return *this;
+  }
+
+  constexpr iterator &operator-=(difference_type n)
+  {
+    m_index -= n;
+    return *this;
+  }
+
+  friend constexpr iterator operator+(iterator it, difference_type n)
+  {
+    return it += n;
+  }
+
+  friend constexpr iterator operator+(difference_type n, iterator it)
+  {
+    return it += n;
+  }
+
+  friend constexpr iterator operator-(iterator it, difference_type n)
+  {
+    return it -= n;
+  }
+
+  friend constexpr difference_type operator-(iterator const &lhs, iterator const &rhs)
+  {
+    return lhs.m_index - rhs.m_index;
+  }
+
+  friend constexpr bool operator==(iterator const &lhs, iterator const &rhs)
+  {
+    return lhs.m_index == rhs.m_index;
+  }
+
+  friend constexpr auto operator<=>(iterator const &lhs, iterator const &rhs)
+  {
+    return lhs.m_index <=> rhs.m_index;
+  }
+
+private:
+  friend class iterator<!is_const>;
+
+  base_iterator m_first = base_iterator();
+  difference_type m_step = 1;
+  difference_type m_index = 0;  // in strided elements; end() holds the clamped count
+};
+
+template<typename R>
+strided_view(R &&, std::ranges::range_difference_t<R>) -> strided_view<std::views::all_t<R>>;
+
+template<typename V>
+inline constexpr bool std::ranges::enable_borrowed_range<strided_view<V>> =
+  std::ranges::enable_borrowed_range<V>;
+
+template<std::ranges::viewable_range R>
+constexpr auto make_strided_view(R &&range, std::ranges::range_difference_t<R> step)
+{
+  return strided_view(std::forward<R>(range), step);
+}
+
+/// range adaptor closure for use as range | strided(3) | std::views::reverse
+struct strided
+{
+  std::ptrdiff_t step;
+
+  template<std::ranges::viewable_range R>
+  friend constexpr auto operator|(R &&range, strided const &adaptor)
+  {
+    return make_strided_view(std::forward<R>(range),
+      static_cast<std::ranges::range_difference_t<R>>(adaptor.step));
+  }
+};
+
+#endif // __cplusplus >= 202002L
@@ -0,0 +1,270 @@
+#pragma once
+
+#include "iterator_custom_step.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+
+#if defined(__GLIBC__) || defined(__linux__)
+# include <unistd.h>
+#endif
+
+// cache-blocked traversal of row-major 2D data; column-wise passes over
+// custom_step_iterator with step = row stride miss the cache on every
+// element for large matrices, so the helpers below walk tiles sized to
+// fit the detected cache instead
+
+/// data cache sizes in bytes
+struct cache_sizes
+{
+  std::size_t l1;
+  std::size_t l2;
+
+  /// @return  sizes of the executing machine, or common defaults
+  ///          where they cannot be detected
+  static const cache_sizes& detected()
+  {
+    static const cache_sizes sizes = detect();
+    return sizes;
+  }
+
+private:
+  static cache_sizes detect()
+  {
+    cache_sizes sizes{32 * 1024, 256 * 1024};
+#if defined(_SC_LEVEL1_DCACHE_SIZE) && defined(_SC_LEVEL2_CACHE_SIZE)
+    auto l1 = ::sysconf(_SC_LEVEL1_DCACHE_SIZE);
+    auto l2 = ::sysconf(_SC_LEVEL2_CACHE_SIZE);
+    if(l1 > 0) {
+      sizes.l1 = static_cast<std::size_t>(l1);
+    }
+    if(l2 > 0) {
+      sizes.l2 = static_cast<std::size_t>(l2);
+    }
+#endif
+    return sizes;
+  }
+};
+
+/// @return  power of two edge length of square tiles of which
+///          tiles fit into cache_bytes together
+template<typename T>
+std::size_t tile_edge(std::size_t cache_bytes, std::size_t tiles = 2)
+{
+  const auto elements = cache_bytes / (tiles * sizeof(T));
+  std::size_t edge = 8;
+  while((2 * edge) * (2 * edge) <= elements) {
+    edge *= 2;
+  }
+  return edge;
+}
+
+/// row-major 2D view of the data at first
+template<typename wrapped_iterator>
+struct matrix_view
+{
+  using difference_type = typename std::iterator_traits<wrapped_iterator>::difference_type;
+  using reference = typename std::iterator_traits<wrapped_iterator>::reference;
+  using column_iterator = custom_step_iterator<wrapped_iterator>;
+
+  wrapped_iterator first;
+  difference_type rows;
+  difference_type cols;
+  difference_type stride;  // elements between the starts of two rows
+
+  reference operator()(difference_type r, difference_type c) const
+  {
+    return first[r * stride + c];
+  }
+
+  wrapped_iterator row_begin(difference_type r) const
+  {
+    return first + r * stride;
+  }
+
+  wrapped_iterator row_end(difference_type r) const
+  {
+    return first + r * stride + cols;
+  }
+
+  /// @note  there is no column_end as stepping past the last row leaves
+  ///        the data, see the TODO in iterator_custom_step.h; visit a
+  ///        column with operator() or, with C++20, with a strided_view
+  ///        of the data from column c on
+  column_iterator column_begin(difference_type c) const
+  {
+    return make_custom_step_iterator(first + c, stride);
+  }
+
+  /// @return  sub-view of h x w elements at row r and column c,
+  ///          clamped to the view's extent
+  matrix_view tile(difference_type r, difference_type c,
+                   difference_type h, difference_type w) const
+  {
+    return matrix_view{first + r * stride + c,
+      std::min(h, rows - r), std::min(w, cols - c), stride};
+  }
+};
+
+template<typename wrapped_iterator>
+matrix_view<wrapped_iterator>
+make_matrix_view(
+  wrapped_iterator first,
+  typename std::iterator_traits<wrapped_iterator>::difference_type rows,
+  typename std::iterator_traits<wrapped_iterator>::difference_type cols,
+  typename std::iterator_traits<wrapped_iterator>::difference_type stride)
+{
+  return matrix_view<wrapped_iterator>{first, rows, cols, stride};
+}
+
+template<typename wrapped_iterator>
+matrix_view<wrapped_iterator>
+make_matrix_view(
+  wrapped_iterator first,
+  typename std::iterator_traits<wrapped_iterator>::difference_type rows,
+  typename std::iterator_traits<wrapped_iterator>::difference_type cols)
+{
+  return matrix_view<wrapped_iterator>{first, rows, cols, cols};
+}
+
+/// forward iterator over the tiles of a matrix_view, row of tiles by row of tiles;
+/// dereferences to the tile's matrix_view
+template<typename wrapped_iterator>
+struct tile_iterator
+{
+  using iterator_category = std::forward_iterator_tag;
+  using value_type = matrix_view<wrapped_iterator>;
+  using difference_type = typename value_type::difference_type;
+  using pointer = const value_type*;
+  using reference = value_type;
+
+  value_type matrix;
+  difference_type height;
+  difference_type width;
+  difference_type row;
+  difference_type col;
+
+  reference operator*() const
+  {
+    return matrix.tile(row, col, height, width);
+  }
+
+  tile_iterator& operator++() noexcept
+  {
+    col += width;
+    if(col >= matrix.cols) {
+      col = 0;
+      row += height;
+    }
+    return *this;
+  }
+
+  tile_iterator operator++(int) noexcept
+  {
+    auto tmp = *this;
+    ++*this;
+    return tmp;
+  }
+
+  friend bool operator==(const tile_iterator& lhs, const tile_iterator& rhs) noexcept
+  {
+    return (lhs.row == rhs.row) && (lhs.col == rhs.col);
+  }
+
+  friend bool operator!=(const tile_iterator& lhs, const tile_iterator& rhs) noexcept
+  {
+    return !(lhs == rhs);
+  }
+};
+
+template<typename wrapped_iterator>
+tile_iterator<wrapped_iterator>
+tiles_begin(
+  const matrix_view<wrapped_iterator>& matrix,
+  typename matrix_view<wrapped_iterator>::difference_type height,
+  typename matrix_view<wrapped_iterator>::difference_type width)
+{
+  return tile_iterator<wrapped_iterator>{matrix, height, width, 0, 0};
+}
+
+template<typename wrapped_iterator>
+tile_iterator<wrapped_iterator>
+tiles_end(
+  const matrix_view<wrapped_iterator>& matrix,
+  typename matrix_view<wrapped_iterator>::difference_type height,
+  typename matrix_view<wrapped_iterator>::difference_type width)
+{
+  // the row of tiles past the last one
+  const auto rows = (matrix.cols > 0 ?
+    (matrix.rows + height - 1) / height * height : 0);
+  return tile_iterator<wrapped_iterator>{matrix, height, width, rows, 0};
+}
+
+/// @brief  call fn(element, row, column) for all elements,
+///         tile by tile and row by row within a tile
+/// @param  edge  tile edge length; 0 to derive it from the L1 cache size
+template<typename wrapped_iterator, typename function>
+function tiled_for_each(
+  const matrix_view<wrapped_iterator>& matrix,
+  function fn,
+  typename matrix_view<wrapped_iterator>::difference_type edge = 0)
+{
+  using value_type = typename std::iterator_traits<wrapped_iterator>::value_type;
+  using difference_type = typename matrix_view<wrapped_iterator>::difference_type;
+
+  if(edge <= 0) {
+    edge = static_cast<difference_type>(
+      tile_edge<value_type>(cache_sizes::detected().l1, 1));
+  }
+
+  const auto end = tiles_end(matrix, edge, edge);
+  for(auto it = tiles_begin(matrix, edge, edge); it != end; ++it) {
+    const auto tile = *it;
+    for(difference_type r = 0; r < tile.rows; ++r) {
+      auto elem = tile.row_begin(r);
+      for(difference_type c = 0; c < tile.cols; ++c, ++elem) {
+        fn(*elem, it.row + r, it.col + c);
+      }
+    }
+  }
+  return fn;
+}
+
+/// @brief  dst(c, r) = src(r, c) in two levels of blocking;
+///         blocks sized for L2 made up of tiles sized for L1
+/// @note  dst must be a src.cols x src.rows view and must not overlap src
+template<typename in_iterator, typename out_iterator>
+void blocked_transpose(
+  const matrix_view<in_iterator>& src,
+  const matrix_view<out_iterator>& dst)
+{
+  using value_type = typename std::iterator_traits<in_iterator>::value_type;
+  using difference_type = typename matrix_view<in_iterator>::difference_type;
+
+  const auto& caches = cache_sizes::detected();
+  const auto inner = static_cast<difference_type>(tile_edge<value_type>(caches.l1));
+  const auto outer = std::max(inner,
+    static_cast<difference_type>(tile_edge<value_type>(caches.l2)));
+
+  for(difference_type R = 0; R < src.rows; R += outer) {
+    for(difference_type C = 0; C < src.cols; C += outer) {
+      const auto rEnd = std::min(R + outer, src.rows);
+      const auto cEnd = std::min(C + outer, src.cols);
+
+      for(difference_type r0 = R; r0 < rEnd; r0 += inner) {
+        for(difference_type c0 = C; c0 < cEnd; c0 += inner) {
+          const auto r1 = std::min(r0 + inner, rEnd);
+          const auto c1 = std::min(c0 + inner, cEnd);
+
+          for(auto r = r0; r < r1; ++r) {
+            auto in = src.row_begin(r) + c0;
+            for(auto c = c0; c < c1; ++c, ++in) {
+              dst(c, r) = *in;
+            }
+          }
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,299 @@
+#ifndef PRINT_ASYNC_H
+#define PRINT_ASYNC_H
+
+#include "print_unmangled.h" // for PrintSink
+
+#include <atomic> // for std::atomic
+#include <chrono> // for std::chrono::milliseconds
+#include <condition_variable> // for std::condition_variable
+#include <cstddef> // for std::size_t
+#include <iostream> // for std::cout
+#include <memory> // for std::unique_ptr
+#include <mutex> // for std::mutex
+#include <sstream> // for std::ostringstream
+#include <string> // for std::string
+#include <thread> // for std::thread
+
+/// @brief  asynchronous PrintUnmangled backend; completed lines are pushed
+///         to a lock-free ring buffer and written to the stream by a
+///         background thread
+/// @note  use as PrintUnmangled(printAsync) << "text" << std::endl;
+/// @note  all lines pushed before destruction are written and flushed
+///        by the destructor; give the instance static storage duration
+///        to flush on exit
+class PrintAsync : public PrintSink
+{
+public:
+  /// behaviour when pushing to a full ring buffer
+  enum class Overflow
+  {
+    Block,     ///< wait for the background thread to make room
+    Drop,      ///< discard the new line and count it
+    Overwrite  ///< discard the oldest pending line and count it
+  };
+
+  /// @brief  turns a batch of pushed lines into text, e.g. PrintDeferred::Decode
+  using Decoder = void (*)(char const *data, std::size_t size, std::ostream &os);
+
+  /// @brief  start the background thread
+  /// @param  os  stream to write to
+  /// @param  capacity  ring buffer size in lines; rounded up to a power of two
+  /// @param  overflow  full ring buffer policy
+  /// @param  decoder  optional formatting of the lines on the background thread
+  PrintAsync(std::ostream &os = std::cout,
+             std::size_t capacity = 1024U,
+             Overflow overflow = Overflow::Block,
+             Decoder decoder = nullptr)
+    : m_out(os)
+    , m_overflow(overflow)
+    , m_decoder(decoder)
+    , m_mask(RoundUp(capacity) - 1U)
+    , m_slots(new Slot[m_mask + 1U])
+    , m_enqueuePos(0U)
+    , m_dequeuePos(0U)
+    , m_written(0U)
+    , m_dropped(0U)
+    , m_sleeping(false)
+    , m_shouldStop(false)
+  {
+    for(std::size_t i = 0U; i <= m_mask; ++i) {
+      m_slots[i].seq.store(i, std::memory_order_relaxed);
+    }
+    m_thread = std::thread(&PrintAsync::Worker, this);
+  }
+
+  /// write all pending lines, flush the stream and stop the background thread
+  ~PrintAsync()
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_shouldStop = true;
+    }
+    m_cv.notify_one();
+
+    if(m_thread.joinable()) {
+      m_thread.join();
+    }
+  }
+
+  /// @brief  push a completed line to the ring buffer
+  /// @note  lock-free unless the overflow policy is Block and the buffer is full
+  void Write(char const *data, std::size_t size, bool flush) override
+  {
+    for(;;) {
+      if(TryPush(data, size, flush)) {
+        break;
+      }
+
+      switch(m_overflow) {
+      case Overflow::Block:
+        Wake();
+        std::this_thread::yield();
+        break;
+      case Overflow::Drop:
+        m_dropped.fetch_add(1U, std::memory_order_relaxed);
+        return;
+      case Overflow::Overwrite:
+        if(TryPop(nullptr)) {
+          m_dropped.fetch_add(1U, std::memory_order_relaxed);
+          m_written.fetch_add(1U, std::memory_order_release);
+        }
+        break;
+      }
+    }
+
+    Wake();
+  }
+
+  /// block until all lines pushed so far have been written and flushed
+  void Flush()
+  {
+    auto const target = m_enqueuePos.load(std::memory_order_acquire);
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_flushRequested = true;
+    m_cv.notify_one();
+    m_doneCv.wait(lock,
+      [&]() -> bool {
+        return (m_written.load(std::memory_order_acquire) >= target);
+      });
+    lock.unlock();
+
+    std::lock_guard<std::mutex> outLock(PrintUnmangled::mutex(m_out));
+    m_out.flush();
+  }
+
+  /// @return  number of lines discarded due to the overflow policy
+  std::size_t Dropped() const noexcept
+  {
+    return m_dropped.load(std::memory_order_relaxed);
+  }
+
+private:
+  struct Slot
+  {
+    std::atomic<std::size_t> seq;
+    std::string line;  // capacity is reused to avoid allocations
+    bool flush;
+  };
+
+  // bounded MPMC queue after D. Vyukov; the background thread is the
+  // regular consumer, producers only pop with the Overwrite policy
+  bool TryPush(char const *data, std::size_t size, bool flush)
+  {
+    auto pos = m_enqueuePos.load(std::memory_order_relaxed);
+    for(;;) {
+      auto &slot = m_slots[pos & m_mask];
+      auto const seq = slot.seq.load(std::memory_order_acquire);
+      auto const diff = static_cast<std::ptrdiff_t>(seq - pos);
+      if(diff == 0) {
+        if(m_enqueuePos.compare_exchange_weak(pos, pos + 1U, std::memory_order_relaxed)) {
+          slot.line.assign(data, size);
+          slot.flush = flush;
+          slot.seq.store(pos + 1U, std::memory_order_release);
+          return true;
+        }
+      } else if(diff < 0) {
+        // full
+        return false;
+      } else {
+        pos = m_enqueuePos.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  /// @param  batch  string to append the line to or nullptr to discard it
+  /// @param  flush  set if the line needs flushing
+  /// @return  false if there was no line
+  bool TryPop(std::string *batch, bool *flush = nullptr)
+  {
+    auto pos = m_dequeuePos.load(std::memory_order_relaxed);
+    for(;;) {
+      auto &slot = m_slots[pos & m_mask];
+      auto const seq = slot.seq.load(std::memory_order_acquire);
+      auto const diff = static_cast<std::ptrdiff_t>(seq - (pos + 1U));
+      if(diff == 0) {
+        if(m_dequeuePos.compare_exchange_weak(pos, pos + 1U, std::memory_order_relaxed)) {
+          if(batch) {
+            batch->append(slot.line);
+          }
+          if(flush) {
+            *flush = (*flush || slot.flush);
+          }
+          slot.seq.store(pos + m_mask + 1U, std::memory_order_release);
+          return true;
+        }
+      } else if(diff < 0) {
+        // empty
+        return false;
+      } else {
+        pos = m_dequeuePos.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  bool Pending() const
+  {
+    return (m_written.load(std::memory_order_acquire) !=
+            m_enqueuePos.load(std::memory_order_acquire));
+  }
+
+  void Wake()
+  {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if(m_sleeping.load(std::memory_order_relaxed)) {
+      { // synchronize with the worker going to sleep
+        std::lock_guard<std::mutex> lock(m_mutex);
+      }
+      m_cv.notify_one();
+    }
+  }
+
+  void Worker()
+  {
+    std::string batch;
+    std::ostringstream decoded;
+    for(;;) {
+      // collect up to a buffer's worth of pending lines into one write
+      bool flush = false;
+      std::size_t popped = 0U;
+      for(; (popped <= m_mask) && TryPop(&batch, &flush); ++popped) {
+      }
+
+      if(!batch.empty() && m_decoder) {
+        decoded.str("");
+        m_decoder(batch.data(), batch.size(), decoded);
+        batch = decoded.str();
+      }
+
+      if(!batch.empty()) {
+        {
+          std::lock_guard<std::mutex> lock(PrintUnmangled::mutex(m_out));
+          m_out.write(batch.data(), static_cast<std::streamsize>(batch.size()));
+          if(flush) {
+            m_out.flush();
+          }
+        }
+        batch.clear();
+      }
+      // count only now that the lines are out, Flush relies on that
+      m_written.fetch_add(popped, std::memory_order_release);
+
+      std::unique_lock<std::mutex> lock(m_mutex);
+      if(m_flushRequested) {
+        // keep notifying until the waiters' lines are all written
+        m_flushRequested = Pending();
+        m_doneCv.notify_all();
+      }
+
+      if(Pending()) {
+        // more lines arrived or a producer is still writing its slot
+        lock.unlock();
+        std::this_thread::yield();
+        continue;
+      } else if(m_shouldStop) {
+        break;
+      }
+
+      m_sleeping.store(true, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if(!Pending() && !m_shouldStop && !m_flushRequested) {
+        // timeout as a safety net only
+        (void)m_cv.wait_for(lock, std::chrono::milliseconds(100));
+      }
+      m_sleeping.store(false, std::memory_order_relaxed);
+    }
+
+    std::lock_guard<std::mutex> outLock(PrintUnmangled::mutex(m_out));
+    m_out.flush();
+  }
+
+  static std::size_t RoundUp(std::size_t capacity)
+  {
+    std::size_t size = 2U;
+    while(size < capacity) {
+      size <<= 1U;
+    }
+    return size;
+  }
+
+private:
+  std::ostream &m_out;
+  Overflow const m_overflow;
+  Decoder const m_decoder;
+  std::size_t const m_mask;
+  std::unique_ptr<Slot[]> m_slots;
+  alignas(64) std::atomic<std::size_t> m_enqueuePos;
+  alignas(64) std::atomic<std::size_t> m_dequeuePos;
+  alignas(64) std::atomic<std::size_t> m_written;  // lines written or discarded
+  std::atomic<std::size_t> m_dropped;
+  std::atomic<bool> m_sleeping;
+  std::mutex m_mutex;
+  bool m_shouldStop;  // guarded by m_mutex
+  bool m_flushRequested = false;  // guarded by m_mutex
+  std::condition_variable m_cv;
+  std::condition_variable m_doneCv;
+  std::thread m_thread;
+};
+
+#endif // PRINT_ASYNC_H
@@ -0,0 +1,478 @@
+#ifndef PRINT_DEFERRED_H
+#define PRINT_DEFERRED_H
+
+#include "print_unmangled.h" // for PrintSink
+
+#include <algorithm> // for std::min
+#include <cstdint> // for std::uint32_t
+#include <cstring> // for std::memcpy
+#include <iomanip> // for std::setw
+#include <iostream> // for std::ostream
+#include <memory> // for std::unique_ptr
+#include <sstream> // for std::ostringstream
+#include <string> // for std::string
+#include <string_view> // for std::string_view
+#include <type_traits> // for std::is_integral
+#include <vector> // for std::vector
+
+/// @brief  PrintUnmangled counterpart that captures the streamed values in a
+///         compact binary record instead of formatting them; the record is
+///         handed to a sink and turned into text later by Decode
+/// @note  use with a decoding PrintAsync to format on its background thread:
+///          PrintAsync async(std::cout, 1024U, PrintAsync::Overflow::Block,
+///                           &PrintDeferred::Decode);
+///          PrintDeferred(async) << "value " << 42 << std::endl;
+///        or with a PrintFd to a binary file that is decoded offline
+/// @note  arithmetic values, characters and strings are captured as is;
+///        other types are formatted eagerly through std::ostream
+/// @note  like with PrintUnmangled, format manipulators apply to the rest
+///        of the statement; each record carries the format state it needs;
+///        widths and precisions beyond 4096 are taken for corrupt data
+/// @note  records use the native byte order and are decoded on
+///        the same architecture only
+struct PrintDeferred
+{
+  using Ioo = std::ostream &(*)(std::ostream &);
+  using Iob = std::ios_base &(*)(std::ios_base &);
+
+  /// hand completed records to given sink
+  PrintDeferred(PrintSink &sink)
+    : sink(sink)
+    , record(acquired())
+  {
+  }
+
+  PrintDeferred(PrintDeferred const &) = delete;
+  PrintDeferred &operator=(PrintDeferred const &) = delete;
+
+  ~PrintDeferred()
+  {
+    if(record->data.size() > sizeof(Size)) {
+      completed(false);
+    }
+    released(std::move(record));
+  }
+
+  template<typename T>
+  PrintDeferred &operator<<(T const &value);
+
+  PrintDeferred &operator<<(Ioo value);
+  PrintDeferred &operator<<(Iob value);
+
+  /// @brief  format a sequence of complete records
+  /// @param  data  records as handed to the sink
+  /// @param  os  stream to write the text to
+  /// @note  stops at the first corrupt record
+  static void Decode(char const *data, std::size_t size, std::ostream &os);
+
+  /// @brief  format records read from a binary stream, e.g. a file written by PrintFd
+  /// @note  stops at the first corrupt or truncated record
+  static void Decode(std::istream &is, std::ostream &os);
+
+private:
+  using Size = std::uint32_t;
+
+  enum class Tag : unsigned char
+  {
+    Bool,
+    Char,
+    Int8, Int16, Int32, Int64,
+    UInt8, UInt16, UInt32, UInt64,
+    Float, Double, LongDouble,
+    String,
+    Put,  ///< unformatted character, e.g. of std::endl
+    Format  ///< flags, precision, width and fill for the following values
+  };
+
+  /// record under construction along with the statement's format state
+  struct Record
+  {
+    std::string data;
+    std::ostream format;  // without stream buffer, holds the state only
+    bool pending;  // whether format needs to be put before the next value
+
+    Record()
+      : format(nullptr)
+      , pending(false)
+    {
+      data.reserve(256U);
+    }
+  };
+  using RecordPtr = std::unique_ptr<Record>;
+
+  template<typename T>
+  static constexpr Tag IntegralTag()
+  {
+    constexpr Tag tags[2][4] = {
+      {Tag::UInt8, Tag::UInt16, Tag::UInt32, Tag::UInt64},
+      {Tag::Int8, Tag::Int16, Tag::Int32, Tag::Int64}};
+    return tags[std::is_signed<T>::value]
+      [(sizeof(T) == 1U) ? 0 : (sizeof(T) == 2U) ? 1 : (sizeof(T) == 4U) ? 2 : 3];
+  }
+
+  /// whether T is the result of std::setw, std::setprecision and alike
+  template<typename T>
+  static constexpr bool IsFormat = false
+    || std::is_same<T, decltype(std::setw(0))>::value
+    || std::is_same<T, decltype(std::setprecision(0))>::value
+    || std::is_same<T, decltype(std::setfill('\0'))>::value
+    || std::is_same<T, decltype(std::setbase(0))>::value
+    || std::is_same<T, decltype(std::setiosflags(std::ios_base::fmtflags()))>::value
+    || std::is_same<T, decltype(std::resetiosflags(std::ios_base::fmtflags()))>::value;
+
+  static bool IsDefault(std::ostream const &format);
+
+  /// @return  whether a decoded format state is one std::ostream can apply;
+  ///          the stream pads and formats numbers on the stack, so
+  ///          larger widths and precisions are considered corrupt
+  static bool IsValid(std::ios_base::fmtflags flags,
+                      std::streamsize precision, std::streamsize width);
+
+  static std::vector<RecordPtr> &pool();
+  static RecordPtr acquired();
+  static void released(RecordPtr record);
+
+  template<typename T>
+  void append(T const &value);
+  template<typename T>
+  void put(Tag tag, T const &value);
+  void putString(char const *data, std::size_t size);
+
+  void completed(bool flush);
+
+  /// @return  false if the records are corrupt
+  static bool Decoded(char const *data, char const *end, std::ostream &os);
+
+  /// @return  false if there are not enough bytes before end
+  template<typename T>
+  static bool got(char const *&data, char const *end, T &value);
+
+  /// @return  false if there are not enough bytes before end
+  template<typename T, typename As = T>
+  static bool printed(char const *&data, char const *end, std::ostream &os);
+
+private:
+  PrintSink &sink;
+  RecordPtr record;
+};
+
+template<typename T>
+PrintDeferred &PrintDeferred::operator<<(T const &value)
+{
+  using Decayed = std::decay_t<T>;
+
+  if constexpr(IsFormat<Decayed>) {
+    record->format << value;
+    record->pending = true;
+  } else if constexpr(std::is_same<Decayed, bool>::value) {
+    put(Tag::Bool, value);
+  } else if constexpr(std::is_same<Decayed, char>::value ||
+                      std::is_same<Decayed, signed char>::value ||
+                      std::is_same<Decayed, unsigned char>::value) {
+    put(Tag::Char, static_cast<char>(value));
+  } else if constexpr(std::is_integral<Decayed>::value) {
+    put(IntegralTag<Decayed>(), value);
+  } else if constexpr(std::is_same<Decayed, float>::value) {
+    put(Tag::Float, value);
+  } else if constexpr(std::is_same<Decayed, double>::value) {
+    put(Tag::Double, value);
+  } else if constexpr(std::is_same<Decayed, long double>::value) {
+    put(Tag::LongDouble, value);
+  } else if constexpr(std::is_same<Decayed, std::string>::value ||
+                      std::is_same<Decayed, std::string_view>::value) {
+    putString(value.data(), value.size());
+  } else if constexpr(std::is_array<T>::value &&
+                      std::is_same<Decayed, char *>::value) {
+    putString(value, std::char_traits<char>::length(value));
+  } else if constexpr(std::is_same<Decayed, char *>::value ||
+                      std::is_same<Decayed, char const *>::value) {
+    if(value) {
+      putString(value, std::char_traits<char>::length(value));
+    }
+  } else {
+    // no binary representation; format now, consuming the width
+    std::ostringstream oss;
+    oss.flags(record->format.flags());
+    oss.precision(record->format.precision());
+    oss.width(record->format.width());
+    oss.fill(record->format.fill());
+    oss << value;
+    record->format.width(0);
+    auto const str = oss.str();
+    putString(str.data(), str.size());
+  }
+  return *this;
+}
+
+inline PrintDeferred &PrintDeferred::operator<<(Ioo value)
+{
+  using Traits = std::char_traits<char>;
+  if(value == static_cast<Ioo>(&std::endl<char, Traits>)) {
+    put(Tag::Put, '\n');
+  } else if(value == static_cast<Ioo>(&std::ends<char, Traits>)) {
+    put(Tag::Put, '\0');
+  }
+  completed(true);
+  return *this;
+}
+
+inline PrintDeferred &PrintDeferred::operator<<(Iob value)
+{
+  record->format << value;
+  record->pending = true;
+  return *this;
+}
+
+inline bool PrintDeferred::IsDefault(std::ostream const &format)
+{
+  return ((format.flags() == (std::ios_base::skipws | std::ios_base::dec)) &&
+          (format.precision() == 6) &&
+          (format.width() == 0) &&
+          (format.fill() == ' '));
+}
+
+inline bool PrintDeferred::IsValid(std::ios_base::fmtflags flags,
+                                   std::streamsize precision, std::streamsize width)
+{
+  constexpr std::ios_base::fmtflags known = std::ios_base::boolalpha |
+    std::ios_base::dec | std::ios_base::fixed | std::ios_base::hex |
+    std::ios_base::internal | std::ios_base::left | std::ios_base::oct |
+    std::ios_base::right | std::ios_base::scientific | std::ios_base::showbase |
+    std::ios_base::showpoint | std::ios_base::showpos | std::ios_base::skipws |
+    std::ios_base::unitbuf | std::ios_base::uppercase;
+  constexpr std::streamsize limit = 4096;
+
+  return ((flags & ~known) == std::ios_base::fmtflags()) &&
+         (precision >= 0) && (precision <= limit) &&
+         (width >= 0) && (width <= limit);
+}
+
+inline std::vector<PrintDeferred::RecordPtr> &PrintDeferred::pool()
+{
+  thread_local std::vector<RecordPtr> records;
+  return records;
+}
+
+inline PrintDeferred::RecordPtr PrintDeferred::acquired()
+{
+  auto &records = pool();
+  RecordPtr record;
+  if(records.empty()) {
+    record = std::make_unique<Record>();
+  } else {
+    record = std::move(records.back());
+    records.pop_back();
+  }
+
+  // reserve the record size
+  record->data.assign(sizeof(Size), '\0');
+  return record;
+}
+
+inline void PrintDeferred::released(RecordPtr record)
+{
+  // restore the initial std::basic_ios state for the next user
+  record->format.flags(std::ios_base::skipws | std::ios_base::dec);
+  record->format.precision(6);
+  record->format.width(0);
+  record->format.fill(' ');
+  record->pending = false;
+
+  pool().push_back(std::move(record));
+}
+
+template<typename T>
+void PrintDeferred::append(T const &value)
+{
+  char bytes[sizeof(T)];
+  std::memcpy(bytes, &value, sizeof(T));
+  record->data.append(bytes, sizeof(bytes));
+}
+
+template<typename T>
+void PrintDeferred::put(Tag tag, T const &value)
+{
+  auto &format = record->format;
+  if(record->pending) {
+    record->pending = false;
+    append(Tag::Format);
+    append(format.flags());
+    append(format.precision());
+    append(format.width());
+    append(format.fill());
+  }
+
+  append(tag);
+  append(value);
+
+  // formatted output consumes the width, also when decoding
+  if(tag != Tag::Put) {
+    format.width(0);
+  }
+}
+
+inline void PrintDeferred::putString(char const *data, std::size_t size)
+{
+  put(Tag::String, static_cast<Size>(size));
+  record->data.append(data, size);
+}
+
+inline void PrintDeferred::completed(bool flush)
+{
+  auto &data = record->data;
+  auto const size = static_cast<Size>(data.size() - sizeof(Size));
+  std::memcpy(&data[0], &size, sizeof(Size));
+
+  sink.Write(data.data(), data.size(), flush);
+  data.resize(sizeof(Size));
+
+  // records are decoded independently, so the next one restates the format
+  record->pending = !IsDefault(record->format);
+}
+
+template<typename T>
+bool PrintDeferred::got(char const *&data, char const *end, T &value)
+{
+  if(static_cast<std::size_t>(end - data) < sizeof(T)) {
+    return false;
+  }
+  std::memcpy(&value, data, sizeof(T));
+  data += sizeof(T);
+  return true;
+}
+
+template<typename T, typename As>
+bool PrintDeferred::printed(char const *&data, char const *end, std::ostream &os)
+{
+  T value;
+  if(!got(data, end, value)) {
+    return false;
+  }
+  os << static_cast<As>(value);
+  return true;
+}
+
+inline bool PrintDeferred::Decoded(char const *data, char const *end, std::ostream &os)
+{
+  while(data != end) {
+    Size size;
+    if(!got(data, end, size) || (size > static_cast<std::size_t>(end - data))) {
+      return false;
+    }
+    auto const recordEnd = data + size;
+
+    // each record starts with the stream's format
+    auto const flags = os.flags();
+    auto const precision = os.precision();
+    auto const width = os.width();
+    auto const fill = os.fill();
+
+    bool ok = true;
+    while(ok && (data < recordEnd)) {
+      switch(static_cast<Tag>(*data++)) {
+      case Tag::Bool: {
+        unsigned char value = 0U;
+        ok = got(data, recordEnd, value) && (value <= 1U);
+        if(ok) {
+          os << (value != 0U);
+        }
+        break;
+      }
+      case Tag::Char: ok = printed<char>(data, recordEnd, os); break;
+      case Tag::Int8: ok = printed<std::int8_t, int>(data, recordEnd, os); break;
+      case Tag::Int16: ok = printed<std::int16_t>(data, recordEnd, os); break;
+      case Tag::Int32: ok = printed<std::int32_t>(data, recordEnd, os); break;
+      case Tag::Int64: ok = printed<std::int64_t>(data, recordEnd, os); break;
+      case Tag::UInt8: ok = printed<std::uint8_t, unsigned>(data, recordEnd, os); break;
+      case Tag::UInt16: ok = printed<std::uint16_t>(data, recordEnd, os); break;
+      case Tag::UInt32: ok = printed<std::uint32_t>(data, recordEnd, os); break;
+      case Tag::UInt64: ok = printed<std::uint64_t>(data, recordEnd, os); break;
+      case Tag::Float: ok = printed<float>(data, recordEnd, os); break;
+      case Tag::Double: ok = printed<double>(data, recordEnd, os); break;
+      case Tag::LongDouble: ok = printed<long double>(data, recordEnd, os); break;
+      case Tag::String: {
+        Size length = 0U;
+        ok = got(data, recordEnd, length) &&
+             (length <= static_cast<std::size_t>(recordEnd - data));
+        if(ok) {
+          os << std::string_view(data, length);
+          data += length;
+        }
+        break;
+      }
+      case Tag::Put: {
+        char c = '\0';
+        ok = got(data, recordEnd, c);
+        if(ok) {
+          os.put(c);
+        }
+        break;
+      }
+      case Tag::Format: {
+        std::ios_base::fmtflags formatFlags;
+        std::streamsize formatPrecision = 0;
+        std::streamsize formatWidth = 0;
+        char formatFill = ' ';
+        ok = got(data, recordEnd, formatFlags) &&
+             got(data, recordEnd, formatPrecision) &&
+             got(data, recordEnd, formatWidth) &&
+             got(data, recordEnd, formatFill) &&
+             IsValid(formatFlags, formatPrecision, formatWidth);
+        if(ok) {
+          os.flags(formatFlags);
+          os.precision(formatPrecision);
+          os.width(formatWidth);
+          os.fill(formatFill);
+        }
+        break;
+      }
+      default:
+        ok = false;
+        break;
+      }
+    }
+
+    os.flags(flags);
+    os.precision(precision);
+    os.width(width);
+    os.fill(fill);
+
+    if(!ok) {
+      return false;
+    }
+  }
+  return true;
+}
+
+inline void PrintDeferred::Decode(char const *data, std::size_t size, std::ostream &os)
+{
+  (void)Decoded(data, data + size, os);
+}
+
+inline void PrintDeferred::Decode(std::istream &is, std::ostream &os)
+{
+  // grow the record as its bytes arrive, not by the size read,
+  // which may be corrupt
+  std::size_t const chunk = 65536U;
+
+  std::string record;
+  Size size;
+  while(is.read(reinterpret_cast<char *>(&size), sizeof(Size))) {
+    record.resize(sizeof(Size));
+    std::memcpy(&record[0], &size, sizeof(Size));
+    for(std::size_t remaining = size; remaining > 0U; ) {
+      auto const n = std::min(remaining, chunk);
+      auto const at = record.size();
+      record.resize(at + n);
+      if(!is.read(&record[at], static_cast<std::streamsize>(n))) {
+        return;
+      }
+      remaining -= n;
+    }
+    if(!Decoded(record.data(), record.data() + record.size(), os)) {
+      return;
+    }
+  }
+}
+
+#endif // PRINT_DEFERRED_H
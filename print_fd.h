@@ -0,0 +1,120 @@
+#ifndef PRINT_FD_H
+#define PRINT_FD_H
+
+#include "print_unmangled.h" // for PrintSink
+
+#include <algorithm> // for std::min
+#include <cerrno> // for errno
+#include <climits> // for IOV_MAX
+#include <condition_variable> // for std::condition_variable
+#include <cstddef> // for std::size_t
+#include <mutex> // for std::mutex
+#include <vector> // for std::vector
+
+#include <sys/uio.h> // for writev
+#include <unistd.h> // for STDOUT_FILENO
+
+/// @brief  PrintUnmangled sink writing directly to a POSIX file descriptor;
+///         lines completed concurrently by several threads are combined
+///         into a single writev call by whichever thread gets to write first
+/// @note  use as PrintUnmangled(printFd) << "text" << std::endl;
+/// @note  Write blocks until the line has been handed to the kernel,
+///        so the caller's line buffer is never copied
+/// @note  write errors other than EINTR silently discard the affected lines
+class PrintFd : public PrintSink
+{
+public:
+  /// @param  fd  file descriptor to write to; not owned
+  explicit PrintFd(int fd = STDOUT_FILENO)
+    : m_fd(fd)
+    , m_writing(false)
+  {
+  }
+
+  void Write(char const *data, std::size_t size, bool) override
+  {
+    Request request{{const_cast<char *>(data), size}, false};
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_pending.push_back(&request);
+
+    // wait for another thread to write our line or to step down
+    m_cv.wait(lock,
+      [&]() -> bool {
+        return (request.done || !m_writing);
+      });
+    if(request.done) {
+      return;
+    }
+
+    // combine the pending lines of all threads until ours is written
+    m_writing = true;
+    while(!request.done) {
+      std::swap(m_batch, m_pending);
+
+      lock.unlock();
+      WriteBatch();
+      lock.lock();
+
+      for(auto &&req : m_batch) {
+        req->done = true;
+      }
+      m_batch.clear();
+    }
+    m_writing = false;
+
+    lock.unlock();
+    m_cv.notify_all();
+  }
+
+private:
+  struct Request
+  {
+    iovec iov;
+    bool done;  // guarded by m_mutex
+  };
+
+  void WriteBatch()
+  {
+    m_iovs.clear();
+    for(auto &&req : m_batch) {
+      if(req->iov.iov_len > 0U) {
+        m_iovs.push_back(req->iov);
+      }
+    }
+
+    auto it = m_iovs.data();
+    auto const end = m_iovs.data() + m_iovs.size();
+    while(it != end) {
+      auto const count = static_cast<int>(std::min<std::ptrdiff_t>(end - it, IOV_MAX));
+      auto written = ::writev(m_fd, it, count);
+      if(written < 0) {
+        if(errno == EINTR) {
+          continue;
+        }
+        break;
+      }
+
+      // skip what has been written, resuming partially written lines
+      while((it != end) && (static_cast<std::size_t>(written) >= it->iov_len)) {
+        written -= static_cast<ssize_t>(it->iov_len);
+        ++it;
+      }
+      if(it != end) {
+        it->iov_base = static_cast<char *>(it->iov_base) + written;
+        it->iov_len -= static_cast<std::size_t>(written);
+      }
+    }
+  }
+
+private:
+  int const m_fd;
+  std::mutex m_mutex;
+  std::condition_variable m_cv;
+  bool m_writing;  // guarded by m_mutex
+  std::vector<Request *> m_pending;  // guarded by m_mutex
+  std::vector<Request *> m_batch;  // used by the writing thread only
+  std::vector<iovec> m_iovs;  // used by the writing thread only
+};
+
+#endif // PRINT_FD_H
@@ -0,0 +1,111 @@
+#ifndef PRINT_LEVEL_H
+#define PRINT_LEVEL_H
+
+#include "print_null.h" // for PrintNull
+#include "print_unmangled.h" // for PrintUnmangled
+
+#include <atomic> // for std::atomic
+#include <iostream> // for std::ostream
+#include <optional> // for std::optional
+#include <type_traits> // for std::conditional_t
+#include <utility> // for std::forward
+
+enum class PrintLevel : int
+{
+  Trace,
+  Debug,
+  Info,
+  Warning,
+  Error,
+  Off
+};
+
+/// lowest PrintLevel that is compiled in; define as e.g. -DPRINT_LEVEL=2
+/// to compile out Trace and Debug output
+#ifndef PRINT_LEVEL
+# define PRINT_LEVEL 0
+#endif // PRINT_LEVEL
+
+constexpr PrintLevel printLevelCompiled = static_cast<PrintLevel>(PRINT_LEVEL);
+
+/// @brief  sink for given level resolved at compile time;
+///         PrintUnmangled if compiled in, PrintNull otherwise
+/// @note  use as PrintAt<PrintLevel::Debug>() << "text" << std::endl;
+template<PrintLevel level>
+using PrintAt = std::conditional_t<
+  (level >= printLevelCompiled),
+  PrintUnmangled,
+  PrintNull>;
+
+/// @brief  value produced by a callable only when it is actually printed
+/// @note  use as PrintAt<PrintLevel::Debug>() << Lazy([&]{ return expensive(); });
+template<typename Fn>
+struct PrintLazy
+{
+  Fn fn;
+};
+
+template<typename Fn>
+PrintLazy<std::decay_t<Fn>> Lazy(Fn &&fn)
+{
+  return PrintLazy<std::decay_t<Fn>>{std::forward<Fn>(fn)};
+}
+
+template<typename Fn>
+std::ostream &operator<<(std::ostream &os, PrintLazy<Fn> const &lazy)
+{
+  return os << lazy.fn();
+}
+
+/// @return  lowest PrintLevel printed by PrintIf; may be changed at runtime
+inline std::atomic<PrintLevel> &PrintLevelThreshold()
+{
+  static std::atomic<PrintLevel> threshold(PrintLevel::Trace);
+  return threshold;
+}
+
+/// @brief  PrintAt with an additional runtime check against PrintLevelThreshold
+/// @note  costs one relaxed load per statement and a well-predicted branch
+///        per operator<< if compiled in, nothing if compiled out; arguments
+///        wrapped in Lazy are only evaluated if enabled
+template<PrintLevel level, bool compiled = (level >= printLevelCompiled)>
+class PrintIf : public PrintNull
+{
+public:
+  using PrintNull::PrintNull;
+};
+
+template<PrintLevel level>
+class PrintIf<level, true>
+{
+public:
+  template<typename... Args>
+  explicit PrintIf(Args &&...args)
+  {
+    if(level >= PrintLevelThreshold().load(std::memory_order_relaxed)) {
+      print.emplace(std::forward<Args>(args)...);
+    }
+  }
+
+  template<typename T>
+  PrintIf &operator<<(T const &value)
+  {
+    if(print) {
+      *print << value;
+    }
+    return *this;
+  }
+
+  PrintIf &operator<<(PrintUnmangled::Ioo value)
+  {
+    if(print) {
+      *print << value;
+    }
+    return *this;
+  }
+
+private:
+  std::optional<PrintUnmangled> print;
+};
+
+#endif // PRINT_LEVEL_H
@@ -5,17 +5,29 @@
 
 struct PrintNull
 {
+  /// accepts and ignores the constructor arguments of PrintUnmangled
+  /// so that either may be chosen at compile time
+  template<typename... Args>
+  explicit PrintNull(Args &&...)
+  {
+  }
+
   template<typename T>
   friend PrintNull &operator<<(PrintNull &os, T const &);
+  template<typename T>
+  friend PrintNull &operator<<(PrintNull &&os, T const &);
 
   using Ioo = std::ostream &(*)(std::ostream &);
   friend PrintNull &operator<<(PrintNull &os, Ioo const &);
+  friend PrintNull &operator<<(PrintNull &&os, Ioo const &);
 
   using Ios = std::ostream &(*)(std::ios &);
   friend PrintNull &operator<<(PrintNull &os, Ios const &);
+  friend PrintNull &operator<<(PrintNull &&os, Ios const &);
 
   using Iob = std::ostream &(*)(std::ios_base &);
   friend PrintNull &operator<<(PrintNull &os, Iob const &);
+  friend PrintNull &operator<<(PrintNull &&os, Iob const &);
 };
 
 template<typename T>
@@ -24,19 +36,40 @@ PrintNull &operator<<(PrintNull &os, T const &)
   return os;
 }
 
+template<typename T>
+PrintNull &operator<<(PrintNull &&os, T const &)
+{
+  return os;
+}
+
 inline PrintNull &operator<<(PrintNull &os, PrintNull::Ioo const &)
 {
   return os;
 }
 
+inline PrintNull &operator<<(PrintNull &&os, PrintNull::Ioo const &)
+{
+  return os;
+}
+
 inline PrintNull &operator<<(PrintNull &os, PrintNull::Ios const &)
 {
   return os;
 }
 
+inline PrintNull &operator<<(PrintNull &&os, PrintNull::Ios const &)
+{
+  return os;
+}
+
 inline PrintNull &operator<<(PrintNull &os, PrintNull::Iob const &)
 {
   return os;
 }
 
+inline PrintNull &operator<<(PrintNull &&os, PrintNull::Iob const &)
+{
+  return os;
+}
+
 #endif // PRINT_NULL_H
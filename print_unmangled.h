@@ -1,10 +1,32 @@
 #ifndef PRINT_UNMANGLED_H
 #define PRINT_UNMANGLED_H
 
+#include <charconv> // for std::to_chars
+#include <cstddef> // for std::size_t
+#include <cstdint> // for std::uintptr_t
 #include <iostream> // for std::cout
+#include <iterator> // for std::begin
+#include <limits> // for std::numeric_limits
+#include <memory> // for std::unique_ptr
 #include <mutex> // for std::mutex
-#include <sstream> // for std::ostringstream
+#include <string> // for std::string
+#include <string_view> // for std::string_view
+#include <type_traits> // for std::is_integral
+#include <vector> // for std::vector
 
+/// destination for the lines completed by PrintUnmangled
+struct PrintSink
+{
+  virtual ~PrintSink() = default;
+
+  /// @brief  write a completed line
+  /// @param  flush  whether the line was completed by a flushing manipulator
+  virtual void Write(char const *data, std::size_t size, bool flush) = 0;
+};
+
+/// @note  lines are formatted into thread-local buffers that are reused;
+///        once warmed up, arithmetic and string values are formatted
+///        without iostreams and without heap allocations
 struct PrintUnmangled
 {
   using Ioo = std::ostream &(*)(std::ostream &);
@@ -12,14 +34,35 @@ struct PrintUnmangled
   using Iob = std::ostream &(*)(std::ios_base &);
 
   PrintUnmangled(std::ostream &os = std::cout)
-    : out(os)
+    : out(&os)
+    , sink(nullptr)
+    , buf(acquired())
   {
   }
 
+  /// write completed lines to given sink instead of a stream
+  PrintUnmangled(PrintSink &sink)
+    : out(nullptr)
+    , sink(&sink)
+    , buf(acquired())
+  {
+  }
+
+  PrintUnmangled(PrintUnmangled const &) = delete;
+  PrintUnmangled &operator=(PrintUnmangled const &) = delete;
+
   ~PrintUnmangled()
   {
-    std::lock_guard<std::mutex> lock(mutex());
-    out << oss.str();
+    auto const &line = buf->line;
+    if(sink) {
+      if(!line.empty()) {
+        sink->Write(line.data(), line.size(), false);
+      }
+    } else {
+      std::lock_guard<std::mutex> lock(mutex(*out));
+      out->write(line.data(), static_cast<std::streamsize>(line.size()));
+    }
+    released(std::move(buf));
   }
 
   template<typename T>
@@ -29,59 +72,220 @@ struct PrintUnmangled
   PrintUnmangled &operator<<(Ios value);
   PrintUnmangled &operator<<(Iob value);
 
+  /// @brief  mutex serializing the writes to given stream
+  /// @note  mutexes are striped by stream address, so writers to
+  ///        different streams rarely contend
+  static std::mutex &mutex(std::ostream &os);
+
 private:
-  static std::mutex &mutex();
+  /// line storage doubling as the stream buffer for values
+  /// that are not formatted natively
+  struct Buffer : std::streambuf
+  {
+    std::string line;
+    std::ostream os;
+
+    Buffer()
+      : os(this)
+    {
+      line.reserve(256U);
+    }
+
+    int_type overflow(int_type c) override
+    {
+      if(!traits_type::eq_int_type(c, traits_type::eof())) {
+        line.push_back(traits_type::to_char_type(c));
+      }
+      return traits_type::not_eof(c);
+    }
+
+    std::streamsize xsputn(char const *s, std::streamsize n) override
+    {
+      line.append(s, static_cast<std::size_t>(n));
+      return n;
+    }
+  };
+  using BufferPtr = std::unique_ptr<Buffer>;
+
+  static std::vector<BufferPtr> &pool();
+  static BufferPtr acquired();
+  static void released(BufferPtr buf);
+
+  /// @return  whether the value may bypass the stream's formatting
+  bool isPlain() const;
+
+  template<typename T>
+  void append(T const &value);
+
   PrintUnmangled &cleared();
 
 private:
-  std::ostream &out;
-  std::ostringstream oss;
+  std::ostream *out;
+  PrintSink *sink;
+  BufferPtr buf;
 };
 
 template<typename T>
 PrintUnmangled &PrintUnmangled::operator<<(T const &value)
 {
-  oss << value;
+  append(value);
   return *this;
 }
 
 inline PrintUnmangled &PrintUnmangled::operator<<(Ioo value)
 {
-  {
-    std::lock_guard<std::mutex> lock(mutex());
-    out << oss.str() << value;
+  auto &line = buf->line;
+  if(sink) {
+    // complete the line and hand it over
+    buf->os << value;
+    sink->Write(line.data(), line.size(), true);
+  } else {
+    std::lock_guard<std::mutex> lock(mutex(*out));
+    out->write(line.data(), static_cast<std::streamsize>(line.size()));
+    *out << value;
   }
   return cleared();
 }
 
 inline PrintUnmangled &PrintUnmangled::operator<<(Ios value)
 {
-  {
-    std::lock_guard<std::mutex> lock(mutex());
-    out << oss.str() << value;
+  auto &line = buf->line;
+  if(sink) {
+    // formatting applies to the remainder of the line
+    buf->os << value;
+    return *this;
+  } else {
+    std::lock_guard<std::mutex> lock(mutex(*out));
+    out->write(line.data(), static_cast<std::streamsize>(line.size()));
+    *out << value;
   }
   return cleared();
 }
 
 inline PrintUnmangled &PrintUnmangled::operator<<(Iob value)
 {
-  {
-    std::lock_guard<std::mutex> lock(mutex());
-    out << oss.str() << value;
+  auto &line = buf->line;
+  if(sink) {
+    // formatting applies to the remainder of the line
+    buf->os << value;
+    return *this;
+  } else {
+    std::lock_guard<std::mutex> lock(mutex(*out));
+    out->write(line.data(), static_cast<std::streamsize>(line.size()));
+    *out << value;
   }
   return cleared();
 }
 
-inline std::mutex &PrintUnmangled::mutex()
+inline std::mutex &PrintUnmangled::mutex(std::ostream &os)
 {
-  static std::mutex mtx;
-  return mtx;
+  static std::mutex mtxs[31];
+  auto const addr = reinterpret_cast<std::uintptr_t>(&os);
+  return mtxs[(addr / alignof(std::ostream)) % std::size(mtxs)];
+}
+
+inline std::vector<PrintUnmangled::BufferPtr> &PrintUnmangled::pool()
+{
+  thread_local std::vector<BufferPtr> buffers;
+  return buffers;
+}
+
+inline PrintUnmangled::BufferPtr PrintUnmangled::acquired()
+{
+  auto &buffers = pool();
+  if(buffers.empty()) {
+    return std::make_unique<Buffer>();
+  }
+
+  auto buf = std::move(buffers.back());
+  buffers.pop_back();
+  return buf;
+}
+
+inline void PrintUnmangled::released(BufferPtr buf)
+{
+  // restore the initial std::basic_ios state for the next user
+  buf->line.clear();
+  buf->os.clear();
+  buf->os.flags(std::ios_base::skipws | std::ios_base::dec);
+  buf->os.precision(6);
+  buf->os.width(0);
+  buf->os.fill(' ');
+
+  pool().push_back(std::move(buf));
+}
+
+inline bool PrintUnmangled::isPlain() const
+{
+  return ((buf->os.flags() == (std::ios_base::skipws | std::ios_base::dec)) &&
+          (buf->os.width() == 0));
+}
+
+template<typename T>
+void PrintUnmangled::append(T const &value)
+{
+  using Decayed = std::decay_t<T>;
+  auto &line = buf->line;
+
+  if constexpr(std::is_same<Decayed, char>::value ||
+               std::is_same<Decayed, signed char>::value ||
+               std::is_same<Decayed, unsigned char>::value) {
+    if(isPlain()) {
+      line.push_back(static_cast<char>(value));
+      return;
+    }
+  } else if constexpr(std::is_same<Decayed, bool>::value) {
+    if(isPlain()) {
+      line.push_back(value ? '1' : '0');
+      return;
+    }
+  } else if constexpr(std::is_integral<Decayed>::value) {
+    if(isPlain()) {
+      char chars[std::numeric_limits<Decayed>::digits10 + 3];
+      auto const res = std::to_chars(std::begin(chars), std::end(chars), value);
+      line.append(chars, res.ptr);
+      return;
+    }
+#if defined(__cpp_lib_to_chars)
+  } else if constexpr(std::is_floating_point<Decayed>::value) {
+    if(isPlain()) {
+      // same as the default %g conversion of std::ostream
+      char chars[64];
+      auto const res = std::to_chars(std::begin(chars), std::end(chars), value,
+        std::chars_format::general, static_cast<int>(buf->os.precision()));
+      if(res.ec == std::errc()) {
+        line.append(chars, res.ptr);
+        return;
+      }
+    }
+#endif // defined(__cpp_lib_to_chars)
+  } else if constexpr(std::is_same<Decayed, std::string>::value ||
+                      std::is_same<Decayed, std::string_view>::value) {
+    if(isPlain()) {
+      line.append(value.data(), value.size());
+      return;
+    }
+  } else if constexpr(std::is_array<T>::value &&
+                      std::is_same<Decayed, char *>::value) {
+    if(isPlain()) {
+      line.append(value);
+      return;
+    }
+  } else if constexpr(std::is_same<Decayed, char *>::value ||
+                      std::is_same<Decayed, char const *>::value) {
+    if(isPlain() && value) {
+      line.append(value);
+      return;
+    }
+  }
+
+  // anything else is formatted by the stream, appending to the line
+  buf->os << value;
 }
 
 inline PrintUnmangled &PrintUnmangled::cleared()
 {
-  oss.str("");
-  oss.clear();
+  buf->line.clear();
 
   return *this;
 }
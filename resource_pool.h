@@ -1,11 +1,19 @@
 #ifndef RESOURCE_POOL_H
 #define RESOURCE_POOL_H
 
+#include "trace_span.h" // for TraceSpan
+
 #include <algorithm> // for std::find_if
 #include <deque> // for std::deque
+#include <exception> // for std::make_exception_ptr
+#include <functional> // for std::function, std::reference_wrapper
+#include <future> // for std::future
 #include <memory> // for std::unique_ptr
 #include <mutex> // for std::mutex
+#include <optional> // for std::optional
 #include <queue> // for std::queue
+#include <stdexcept> // for std::runtime_error
+#include <type_traits> // for std::result_of, std::conditional_t
 
 template<typename Resource>
 struct ResouceRecycler;
@@ -37,8 +45,107 @@ public:
   template<typename... Args>
   ResourcePtr Get(Args&&... args)
   {
+    TraceSpan span("ResourcePool::Get");
     std::lock_guard<std::mutex> lock(m_mtx);
 
+    if(auto resource = Acquire(std::forward<Args>(args)...)) {
+      return resource;
+    } else {
+      throw std::runtime_error("out of resources");
+    }
+  }
+
+  using Waiter = std::function<void(ResourcePtr)>;
+
+  /// Obtain an idle resource or create a new one with given arguments
+  /// without blocking if the pool is exhausted.
+  /// @param  waiter  Called with the resource; right away if one is
+  ///         available, else by the thread returning the next one.
+  ///         Waiters are served in order.
+  /// @note  The waiter should not block the returning thread;
+  ///        it is destroyed without being called if the
+  ///        resource pool is destroyed first.
+  template<typename... Args>
+  void GetAsync(Waiter waiter, Args&&... args)
+  {
+    std::unique_lock<std::mutex> lock(m_mtx);
+
+    auto resource = Acquire(std::forward<Args>(args)...);
+    if(!resource) {
+      m_waiters.push(std::move(waiter));
+      return;
+    }
+
+    lock.unlock();
+    waiter(std::move(resource));
+  }
+
+  /// Run fn(Resource&) on the work queue once a resource is available.
+  /// The resource is returned to the pool when fn is finished. While the pool
+  /// is exhausted, the work load is parked without occupying a thread.
+  /// @param  queue  WorkQueue or alike to assign the work load to.
+  /// @param  args  Arguments in case a new resource is created.
+  /// @return  Future to wait for the work load completition and return value
+  ///          or exception; throws Queue::Cancelled if the work load is
+  ///          discarded by the work queue or the resource pool.
+  /// @note  The queue must outlive the work loads waiting for a resource,
+  ///        e.g. use one queue per pool or wait for the futures before
+  ///        destroying a queue.
+  template<typename Queue, typename Fn, typename... Args>
+  std::future<
+    typename std::result_of<Fn(Resource&)>::type
+  >
+  GetAsync(Queue &queue, Fn&& fn, Args&&... args)
+  {
+    using ReturnType = typename std::result_of<Fn(Resource&)>::type;
+    using Task = AsyncTask<ReturnType, typename std::decay<Fn>::type, typename Queue::Cancelled>;
+
+    auto task = std::make_shared<Task>(std::forward<Fn>(fn));
+    auto future = task->promise.get_future();
+
+    GetAsync(
+      [&queue, task](ResourcePtr resource) {
+        task->resource.emplace(std::move(resource));
+        (void)queue.Assign([task]() { (*task)(); });
+      }, std::forward<Args>(args)...);
+
+    return future;
+  }
+
+private:
+  void Return(Resource *resource)
+  {
+    TraceSpan span("ResourcePool::Return");
+    std::unique_lock<std::mutex> lock(m_mtx);
+
+    auto const it = std::find_if(std::begin(m_busy), std::end(m_busy),
+      [&](typename decltype(m_busy)::const_reference res) -> bool
+      {
+        return (res.get() == resource);
+      });
+    if(it == std::end(m_busy)) {
+      throw std::runtime_error("returned invalid resource");
+    }
+
+    if(m_waiters.empty()) {
+      // move from busy to idle
+      m_idle.push(std::move(*it));
+      m_busy.erase(it);
+    } else {
+      // hand over to the oldest waiter and keep it busy
+      auto waiter = std::move(m_waiters.front());
+      m_waiters.pop();
+      lock.unlock();
+
+      waiter(ResourcePtr{resource, ResouceRecycler<Resource>{*this}});
+    }
+  }
+
+  /// Obtain an idle resource or create a new one; nullptr if exhausted.
+  /// @note  Expects m_mtx to be locked.
+  template<typename... Args>
+  ResourcePtr Acquire(Args&&... args)
+  {
     if(m_idle.empty()) {
       if(m_busy.size() < m_maxSize) {
         m_busy.emplace_front(
@@ -46,7 +153,7 @@ public:
             std::forward<Args>(args)...));
         return {m_busy.front().get(), ResouceRecycler<Resource>{*this}};
       } else {
-        throw std::runtime_error("out of resources");
+        return {nullptr, ResouceRecycler<Resource>{*this}};
       }
     } else {
       // move from idle to busy
@@ -56,30 +163,69 @@ public:
     }
   }
 
-private:
-  void Return(Resource *resource)
+  /// Work load of GetAsync completing its future; fails it with
+  /// Cancelled if destroyed without having run.
+  template<typename ReturnType, typename Fn, typename Cancelled>
+  struct AsyncTask
   {
-    std::lock_guard<std::mutex> lock(m_mtx);
+    explicit AsyncTask(Fn fn)
+      : fn(std::move(fn))
+    {}
 
-    auto const it = std::find_if(std::begin(m_busy), std::end(m_busy),
-      [&](typename decltype(m_busy)::const_reference res) -> bool
-      {
-        return (res.get() == resource);
-      });
-    if(it == std::end(m_busy)) {
-      throw std::runtime_error("returned invalid resource");
+    ~AsyncTask()
+    {
+      if(!done) {
+        promise.set_exception(std::make_exception_ptr(Cancelled("abandoned")));
+      }
     }
 
-    // move from busy to idle
-    m_idle.push(std::move(*it));
-    m_busy.erase(it);
-  }
+    void operator()()
+    {
+      std::optional<Result> result;
+      std::exception_ptr error;
+      try {
+        if constexpr(std::is_void<ReturnType>::value) {
+          fn(**resource);
+          result.emplace(true);
+        } else {
+          result.emplace(fn(**resource));
+        }
+      } catch(...) {
+        error = std::current_exception();
+      }
+      done = true;
+
+      // return to the pool before the work load is considered finished,
+      // the pool may be destroyed as soon as the future is ready
+      resource.reset();
+
+      if(error) {
+        promise.set_exception(error);
+      } else if constexpr(std::is_void<ReturnType>::value) {
+        promise.set_value();
+      } else {
+        promise.set_value(static_cast<ReturnType>(std::move(*result)));
+      }
+    }
+
+    /// fn's return value kept until the resource is returned
+    using Result = std::conditional_t<std::is_void<ReturnType>::value, bool,
+      std::conditional_t<std::is_reference<ReturnType>::value,
+        std::reference_wrapper<std::remove_reference_t<ReturnType>>,
+        ReturnType>>;
+
+    Fn fn;
+    std::promise<ReturnType> promise;
+    std::optional<ResourcePtr> resource;  // set once acquired
+    bool done = false;
+  };
 
 private:
   using ResourceStorage = std::unique_ptr<Resource>;
   size_t m_maxSize;
   std::queue<ResourceStorage> m_idle;
   std::deque<ResourceStorage> m_busy;
+  std::queue<Waiter> m_waiters;
   std::mutex m_mtx;
 };
 
@@ -1,17 +1,41 @@
+#include "alloc_tracker.h"
 #include "fire_and_dont_forget.h"
 #include "helper.h"
+#include "iterator_custom_step_algorithm.h"
+#include "iterator_dance_dance.h"
+#include "iterator_prefetch.h"
+#include "iterator_strided_view.h"
+#include "iterator_tiled.h"
+#include "print_async.h"
+#include "print_deferred.h"
+#include "print_level.h"
+#ifndef _WIN32
+#include "print_fd.h"
+#endif // _WIN32
 #include "print_null.h"
 #include "print_unmangled.h"
 #include "resource_pool.h"
+#include "trace_span.h"
 #include "tracer.h"
 #include "work_queue.h"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <cassert>
+#include <cstdio>
+#include <future>
+#include <iomanip>
 #include <iostream>
+#include <iterator>
+#include <list>
 #include <memory>
+#include <numeric>
+#include <sstream>
 #include <string>
 #include <thread>
 #include <tuple>
+#include <vector>
 
 namespace tuple {
   void test()
@@ -24,6 +48,27 @@ namespace tuple {
   }
 } // namespace tuple
 
+namespace tracer {
+  void test()
+  {
+    TracerScope scope;
+    {
+      Tracer original("quiet");
+      Tracer copy(original);
+      Tracer moved(std::move(copy));
+      copy = moved;
+      moved = std::move(original);
+    }
+
+    auto const counts = scope.Counts();
+    assert(counts.constructed == 1U);
+    assert(counts.copies() == 2U);
+    assert(counts.moves() == 2U);
+    assert(counts.live() == 0);
+    (void)counts;
+  }
+} // namespace tracer
+
 namespace is_any_equal {
   void test()
   {
@@ -40,6 +85,30 @@ namespace is_any_equal {
       << "-> " << IsAnyEqual(std::string("four"), std::string("four"), std::string("five")) << std::endl;
     std::cout << "IsAnyEqual(std::string('six'), std::string('seven'), std::string('six')) " << std::boolalpha
       << "-> " << IsAnyEqual(std::string("six"), std::string("seven"), std::string("six")) << std::endl;
+
+    static_assert(IsAnyEqual(7, 8, 9, 7), "");
+    static_assert(!IsAnyEqual(0, 1, 2, 3, 4, 5, 6, 7, 8, 9), "");
+
+    // the value is not moved from while comparing
+    std::string value("ten");
+    assert(IsAnyEqual(std::move(value), std::string("eleven"), std::string("ten")));
+    assert(value == "ten");
+
+    for(int i = 0; i < 20; ++i) {
+      assert(IsAnyEqual(i, 1, 3, 5, 7, 9, 11, 13, 15, 17, 19) == (i % 2 == 1));
+      assert(IsAnyEqual(static_cast<long long>(i), 2LL, 4LL, 6LL, 8LL, 10LL, 12LL, 14LL, 16LL, 18LL)
+        == ((i > 0) && (i % 2 == 0)));
+    }
+    assert(IsAnyEqual('c', 'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h'));
+    assert(!IsAnyEqual(1LL << 33, 1LL, 2LL, 3LL, 4LL, 5LL, 6LL, 7LL, 8LL));
+
+    constexpr auto methods = MakeStringSet("GET", "HEAD", "POST", "PUT", "DELETE",
+      "CONNECT", "OPTIONS", "TRACE", "PATCH", "");
+    static_assert(methods.Contains("PATCH"), "");
+    static_assert(!methods.Contains("PATCHES"), "");
+    assert(methods.Contains(std::string("DELETE")));
+    assert(methods.Contains(""));
+    assert(!methods.Contains("get"));
   }
 } // namespace is_any_equal
 
@@ -98,6 +167,19 @@ namespace fire_and_dont_forget {
     }
   };
 
+  void workStoppable(std::atomic<bool>& stopped, FireAndDontForget::StopToken token)
+  {
+    while(!token.IsStopRequested()) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    stopped = true;
+  }
+
+  void workStubborn(int duration, FireAndDontForget::StopToken)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(duration));
+  }
+
   void workTraceCopy(Tracer copy)
   {
     (void)copy;
@@ -141,6 +223,20 @@ namespace fire_and_dont_forget {
     }
 
     assert(duration > 5);
+
+    {
+      std::atomic<bool> stopped(false);
+
+      FireAndDontForget storage;
+      storage.DispatchStoppable(workStoppable, std::ref(stopped));
+      storage.RequestStop();
+      storage.DispatchStoppable(workStubborn, 50);
+
+      auto unfinished = storage.Shutdown(std::chrono::milliseconds(10));
+      assert(stopped);
+      assert(unfinished.size() == 1U);
+      (void)unfinished;
+    }
   }
 } // namespace fire_and_dont_forget
 
@@ -204,8 +300,67 @@ namespace work_queue {
     } work;
 
     seconds = workQueue.Assign(&Work::count, work, Tracer()).get();
+
+    {
+      TracerScope scope;
+      (void)workQueue.Assign(&Work::count, work, Tracer()).get();
+      auto const counts = scope.Counts();
+      std::cout << "Assign took " << counts.copies() << " copies and "
+                << counts.moves() << " moves" << std::endl;
+      // the bound argument is copied once into the by-value parameter
+      assert(counts.copies() <= 1U);
+      (void)counts;
+    }
     std::cout << workQueue.Assign(&Work::text, work, seconds).get() << std::endl;
     workQueue.Assign(&Work::sleep, work, seconds).wait();
+
+    auto const isCancelled = [](std::future<int> &future) -> bool {
+      try {
+        (void)future.get();
+        return false;
+      } catch(WorkQueue::Cancelled const &) {
+        return true;
+      }
+    };
+
+    {
+      // hold the worker so that the following work loads are pending
+      std::promise<void> gate;
+      auto blocked = workQueue.Assign([](std::shared_future<void> gate) { gate.wait(); },
+                                      gate.get_future().share());
+      auto cancelled = workQueue.AssignCancellable(count);
+      auto expired = workQueue.AssignUntil(WorkQueue::Clock::now(), count);
+      auto kept = workQueue.AssignUntil(WorkQueue::Clock::now() + std::chrono::hours(1), count);
+      cancelled.Cancel();
+      gate.set_value();
+
+      assert(isCancelled(cancelled.future));
+      assert(isCancelled(expired.future));
+      assert(!isCancelled(kept.future));
+      blocked.get();
+
+      auto const counts = workQueue.Counts();
+      assert(counts.cancelled == 1U);
+      assert(counts.expired == 1U);
+      (void)counts;
+    }
+
+    for(auto shutdown : {WorkQueue::Shutdown::Cancel, WorkQueue::Shutdown::Drain}) {
+      std::promise<void> gate;
+      std::future<int> pending;
+      {
+        WorkQueue queue(shutdown);
+        queue.Assign([](std::shared_future<void> gate) { gate.wait(); },
+                     gate.get_future().share());
+        pending = queue.Assign(count);
+        gate.set_value();
+      }
+      // the worker may dequeue pending before the destructor stops it,
+      // so with Cancel it is run or cancelled but never left unfulfilled
+      auto const cancelled = isCancelled(pending);
+      assert(!cancelled || (shutdown == WorkQueue::Shutdown::Cancel));
+      (void)cancelled;
+    }
   }
 } // namespace work_queue
 
@@ -227,9 +382,178 @@ namespace print_unmangled {
         thread.join();
       }
     }
+
+    // natively formatted values match the std::ostream output
+    std::ostringstream expected;
+    std::ostringstream actual;
+    expected << "text " << std::string("string ") << 'c' << -42 << ' ' << 1.0 / 3.0 << ' '
+             << 1e300 << ' ' << true << ' ' << std::hex << 255 << std::endl;
+    PrintUnmangled(actual) << "text " << std::string("string ") << 'c' << -42 << ' ' << 1.0 / 3.0 << ' '
+                           << 1e300 << ' ' << true << ' ' << std::hex << 255 << std::endl;
+    assert(expected.str() == actual.str());
+
+    // a warmed up line does not allocate
+    struct Discard : PrintSink
+    {
+      void Write(char const *, std::size_t, bool) override {}
+    } discard;
+    {
+      AllocScope scope;
+      PrintUnmangled(discard) << "no " << "allocation " << 42 << ' ' << 0.5 << std::endl;
+      assert(scope.Counts().allocations == 0U);
+    }
   }
 } // namespace print_unmangled
 
+namespace alloc_tracker {
+  void test()
+  {
+    AllocScope outer;
+    {
+      AllocScope inner(true);
+      auto const ptr = std::make_unique<std::string>(100U, 'x');
+      assert(inner.Counts().allocations == 2U);
+      assert(inner.Counts().peak >= 100);
+      assert(inner.CallSiteCount() == 2U);
+      assert(inner.CallSites()[0] != nullptr);
+      assert(outer.CallSiteCount() == 0U);
+    }
+    assert(outer.Counts().allocations == 2U);
+    assert(outer.Counts().deallocations == 2U);
+    assert(outer.Counts().current == 0);
+  }
+} // namespace alloc_tracker
+
+namespace print_async {
+  void test()
+  {
+    {
+      PrintAsync async;
+
+      std::thread threads[4];
+      for(auto &&thread : threads) {
+        thread = std::thread(
+          [&]() -> void
+          {
+            for(int i = 0; i < 10; ++i) {
+              PrintUnmangled(async) << "asynchronous " << "line" << std::endl;
+            }
+          });
+      }
+      for(auto &&thread : threads) {
+        if(thread.joinable()) {
+          thread.join();
+        }
+      }
+    }
+
+    {
+      std::ostringstream oss;
+      {
+        PrintAsync async(oss, 2U, PrintAsync::Overflow::Drop);
+        for(int i = 0; i < 100; ++i) {
+          PrintUnmangled(async) << i << std::endl;
+        }
+        async.Flush();
+
+        auto const text = oss.str();
+        auto const lines = std::count(std::begin(text), std::end(text), '\n');
+        assert(async.Dropped() + static_cast<std::size_t>(lines) == 100U);
+        (void)lines;
+      }
+    }
+  }
+} // namespace print_async
+
+namespace print_deferred {
+  void test()
+  {
+    std::ostringstream expected;
+    expected << "deferred " << std::string("line ") << 'c' << -42 << ' ' << 42U << ' '
+             << 1.0 / 3.0 << ' ' << true << ' ' << std::hex << 255 << std::endl;
+    expected << std::dec << 255 << std::endl;
+
+    std::ostringstream actual;
+    {
+      PrintAsync async(actual, 16U, PrintAsync::Overflow::Block, &PrintDeferred::Decode);
+      PrintDeferred(async) << "deferred " << std::string("line ") << 'c' << -42 << ' ' << 42U << ' '
+                           << 1.0 / 3.0 << ' ' << true << ' ' << std::hex << 255 << std::endl;
+      PrintDeferred(async) << 255 << std::endl;
+    }
+    assert(expected.str() == actual.str());
+
+    // the format applies to the rest of the statement, like with PrintUnmangled
+    std::ostringstream formatted;
+    {
+      PrintAsync async(formatted, 16U, PrintAsync::Overflow::Block, &PrintDeferred::Decode);
+      PrintDeferred(async) << std::setprecision(3) << 1.0 / 3.0 << std::endl;
+      PrintDeferred(async) << std::setw(5) << 42 << '|' << std::setfill('*') << std::setw(4)
+                           << "ab" << '|' << std::left << std::setw(3) << 'c' << std::endl;
+      PrintDeferred(async) << std::hex << std::showbase << 255 << std::endl << 255 << std::endl;
+      PrintDeferred(async) << 255 << ' ' << 1.0 / 3.0 << std::endl;
+    }
+    assert(formatted.str() == "0.333\n   42|**ab|c**\n0xff\n0xff\n255 0.333333\n");
+
+    // corrupt input is not decoded beyond its end
+    auto const decoded = [](std::string const &data) -> std::string {
+      std::ostringstream oss;
+      PrintDeferred::Decode(data.data(), data.size(), oss);
+      std::istringstream is(data);
+      PrintDeferred::Decode(is, oss);
+      return oss.str();
+    };
+    // size, string tag and a length of 0xffff with two characters only
+    assert(decoded(std::string("\x07\0\0\0\x0d\xff\xff\0\0ab", 11U)).empty());
+    // record size beyond the data
+    assert(decoded(std::string("\xff\xff\xff\x0f\x01x", 6U)).empty());
+    // unknown tag after a valid value
+    assert(decoded(std::string("\x04\0\0\0\x01x\xfe\0", 8U)) == "xx");
+    // invalid bool
+    assert(decoded(std::string("\x02\0\0\0\0\x02", 6U)).empty());
+    (void)decoded;
+  }
+} // namespace print_deferred
+
+#ifndef _WIN32
+namespace print_fd {
+  void test()
+  {
+    auto const file = std::tmpfile();
+    assert(file);
+    {
+      PrintFd fd(fileno(file));
+
+      std::thread threads[4];
+      for(auto &&thread : threads) {
+        thread = std::thread(
+          [&]() -> void
+          {
+            for(int i = 0; i < 100; ++i) {
+              PrintUnmangled(fd) << "combined " << "line" << std::endl;
+            }
+          });
+      }
+      for(auto &&thread : threads) {
+        if(thread.joinable()) {
+          thread.join();
+        }
+      }
+    }
+
+    std::rewind(file);
+    char line[32];
+    int lines = 0;
+    while(std::fgets(line, sizeof(line), file)) {
+      assert(std::string(line) == "combined line\n");
+      ++lines;
+    }
+    assert(lines == 400);
+    (void)lines;
+    std::fclose(file);
+  }
+} // namespace print_fd
+#endif // _WIN32
+
 namespace resource_pool {
   void test()
   {
@@ -248,9 +572,124 @@ namespace resource_pool {
     } catch(std::exception const &) {
       std::cout << "don't be greedy" << std::endl;
     }
+
+    // exhaustion parks the work loads until a resource is returned
+    WorkQueue workQueue;
+    std::future<std::string> first;
+    std::future<std::string> second;
+    {
+      auto const ptrOne = pool.Get("1");
+      auto const ptrTwo = pool.Get("2");
+      first = pool.GetAsync(workQueue, [](std::string &resource) { return resource += "a"; });
+      second = pool.GetAsync(workQueue, [](std::string &resource) { return resource += "b"; });
+      assert(first.wait_for(std::chrono::milliseconds(10)) == std::future_status::timeout);
+    }
+    auto const one = first.get();
+    auto const two = second.get();
+    assert((one.back() == 'a') && (two.back() == 'b'));
+    (void)one;
+    (void)two;
+
+    // parked work loads are cancelled along with the pool
+    std::future<std::string> abandoned;
+    {
+      ResourcePool<std::string> exhausted(0U);
+      abandoned = exhausted.GetAsync(workQueue, [](std::string &resource) { return resource; });
+    }
+    try {
+      (void)abandoned.get();
+      assert(false);
+    } catch(WorkQueue::Cancelled const &) {
+    }
+
+    // the resources are returned before the futures are ready,
+    // so the pool may be destroyed right after them
+    {
+      std::vector<std::future<int>> futures(4U * 200U);
+      {
+        ResourcePool<int> contended(2U);
+        std::thread threads[4];
+        for(std::size_t t = 0U; t < 4U; ++t) {
+          threads[t] = std::thread(
+            [&, t]() -> void
+            {
+              for(std::size_t i = t; i < futures.size(); i += 4U) {
+                futures[i] = contended.GetAsync(workQueue, [](int &resource) { return ++resource; });
+              }
+            });
+        }
+        for(auto &&thread : threads) {
+          thread.join();
+        }
+        for(auto &&future : futures) {
+          (void)future.get();
+        }
+      }
+    }
+
+    // references are passed through
+    {
+      ResourcePool<std::string> single(1U);
+      single.GetAsync(workQueue, [](std::string &resource) -> std::string & {
+          return resource;
+        }).get() = "changed";
+      assert(*single.Get() == "changed");
+    }
   }
 } // namespace resource_pool
 
+namespace trace_span {
+  void test()
+  {
+    {
+      TraceSpan span("test \"span\"");
+      WorkQueue workQueue;
+      workQueue.Assign([]() {}).wait();
+    }
+
+    std::ostringstream json;
+    TraceSpans::WriteJson(json);
+#ifdef TRACE_SPANS
+    assert(json.str().find("{\"name\":\"test \\\"span\\\"\",\"ph\":\"X\"") != std::string::npos);
+    assert(json.str().find("WorkQueue task") != std::string::npos);
+
+    // consecutive threads continue the buffer of the exited ones
+    auto const buffers = trace_span_detail::registry().buffers.size();
+    for(int i = 0; i < 10; ++i) {
+      std::thread([]() { TraceSpan span("short-lived thread"); }).join();
+    }
+    assert(trace_span_detail::registry().buffers.size() <= buffers + 1U);
+
+    // a full buffer drops spans until cleared
+    std::thread([]() {
+      for(int i = 0; i < TRACE_SPANS_PER_THREAD + 3; ++i) {
+        TraceSpan span("filling thread");
+      }
+    }).join();
+    assert(TraceSpans::Dropped() >= 3U);
+
+    // clearing discards the recorded spans, and rewinds the full buffer for reuse
+    TraceSpans::Clear();
+    assert(TraceSpans::Dropped() == 0U);
+    {
+      TraceSpan span("after clear");
+    }
+    std::thread([]() { TraceSpan span("after clear on a thread"); }).join();
+    assert(trace_span_detail::registry().buffers.size() <= buffers + 1U);
+    (void)buffers;
+
+    std::ostringstream cleared;
+    TraceSpans::WriteJson(cleared);
+    assert(cleared.str().find("test \\\"span\\\"") == std::string::npos);
+    assert(cleared.str().find("filling thread") == std::string::npos);
+    assert(cleared.str().find("\"after clear\"") != std::string::npos);
+    assert(cleared.str().find("after clear on a thread") != std::string::npos);
+#else // TRACE_SPANS
+    TraceSpans::Clear();
+#endif // TRACE_SPANS
+  }
+} // namespace trace_span
+
 namespace print_null {
   void test()
   {
@@ -259,10 +698,405 @@ namespace print_null {
   }
 } // namespace print_null
 
+namespace print_level {
+  void test()
+  {
+    int evaluated = 0;
+    auto expensive = [&]() -> std::string {
+      ++evaluated;
+      return "expensive";
+    };
+
+    // what a compiled out PrintAt resolves to
+    PrintNull() << Lazy(expensive) << std::endl;
+    assert(evaluated == 0);
+
+    PrintLevelThreshold() = PrintLevel::Warning;
+    PrintIf<PrintLevel::Info>() << Lazy(expensive) << std::endl;
+    assert(evaluated == 0);
+
+    PrintIf<PrintLevel::Error>() << "if " << Lazy(expensive) << std::endl;
+    PrintAt<PrintLevel::Error>() << "at " << Lazy(expensive) << std::endl;
+    assert(evaluated == 2);
+    PrintLevelThreshold() = PrintLevel::Trace;
+  }
+} // namespace print_level
+
+namespace custom_step_algorithm {
+  // kernel result plus scalar tail, like custom_step_detail::gather
+  template<typename T, typename Kernel>
+  std::vector<T> gather_with(Kernel kernel, T const *src, std::ptrdiff_t step, std::size_t count)
+  {
+    std::vector<T> dst(count);
+    for(auto i = kernel(src, step, count, dst.data()); i < count; ++i) {
+      dst[i] = src[static_cast<std::ptrdiff_t>(i) * step];
+    }
+    return dst;
+  }
+
+  // the kernels on data ending at the last strided element, to catch over-reads
+  template<typename T, typename Kernel>
+  void test_kernel(Kernel kernel, std::ptrdiff_t step)
+  {
+    for(std::size_t count = 1U; count < 40U; ++count) {
+      auto const size = (count - 1U) * static_cast<std::size_t>(step) + 1U;
+      std::unique_ptr<T[]> src(new T[size]);
+      std::vector<T> expected;
+      for(std::size_t i = 0U; i < size; ++i) {
+        src[i] = static_cast<T>(i);
+        if(i % static_cast<std::size_t>(step) == 0U) {
+          expected.push_back(src[i]);
+        }
+      }
+
+      assert(gather_with(kernel, src.get(), step, count) == expected);
+    }
+  }
+
+  // the algorithms against plain loops over the strided elements
+  template<typename T>
+  void test_type()
+  {
+    for(std::size_t count : {1U, 3U, 5U, 7U, 9U, 15U, 17U, 31U, 33U, 255U, 257U}) {
+      for(std::ptrdiff_t step = 1; step <= 9; ++step) {
+        std::vector<T> data(count * static_cast<std::size_t>(step));
+        std::vector<T> expected;
+        T sum = T();
+        for(std::size_t i = 0U; i < data.size(); ++i) {
+          data[i] = static_cast<T>(i % 64U);
+          if(i % static_cast<std::size_t>(step) == 0U) {
+            expected.push_back(data[i]);
+            sum += data[i];
+          }
+        }
+        auto const first = make_custom_step_iterator(std::begin(data), step);
+        auto const last = make_custom_step_iterator(std::end(data), step);
+
+        std::vector<T> copied(count);
+        strided_copy(first, last, std::begin(copied));
+        assert(copied == expected);
+
+        std::vector<T> inserted;
+        strided_copy(first, last, std::back_inserter(inserted));
+        assert(inserted == expected);
+
+        std::vector<T> transformed;
+        strided_transform(first, last, std::back_inserter(transformed),
+          [](T value) -> T { return value + T(1); });
+        for(std::size_t i = 0U; i < count; ++i) {
+          assert(transformed[i] == expected[i] + T(1));
+        }
+
+        // small integral values, so that even reordered float sums are exact
+        assert(strided_reduce(first, last, T()) == sum);
+
+        auto const unchanged = data;
+        strided_fill(first, last, T(100));
+        for(std::size_t i = 0U; i < data.size(); ++i) {
+          assert(data[i] == (i % static_cast<std::size_t>(step) == 0U ? T(100) : unchanged[i]));
+        }
+        assert(strided_interleave(std::begin(expected), std::end(expected), first) == last);
+        assert(data == unchanged);
+        (void)sum;
+      }
+    }
+  }
+
+  void test()
+  {
+    test_type<float>();
+    test_type<double>();
+    test_type<int>();
+    test_type<long long>();
+
+#if CUSTOM_STEP_SIMD
+    // the SSE kernel is only picked on machines without AVX2
+    test_kernel<float>(
+      [](float const *src, std::ptrdiff_t, std::size_t count, float *dst) -> std::size_t {
+        return custom_step_detail::gather32_step2_sse(src, count, dst);
+      }, 2);
+
+    if(custom_step_detail::has_avx2()) {
+      for(std::ptrdiff_t step = 1; step <= 9; ++step) {
+        test_kernel<float>(&custom_step_detail::gather32_avx2, step);
+        test_kernel<double>(&custom_step_detail::gather64_avx2, step);
+      }
+    }
+#endif // CUSTOM_STEP_SIMD
+  }
+} // namespace custom_step_algorithm
+
+namespace dance_dance {
+  template<typename Iterator>
+  std::vector<int> walked(Iterator first, Iterator last)
+  {
+    std::vector<int> result;
+    for(; first != last; ++first) {
+      result.push_back(*first);
+    }
+    return result;
+  }
+
+  void test()
+  {
+    std::vector<int> values(10);
+    std::iota(std::begin(values), std::end(values), 0);
+
+    // 7 steps of 1, 2, 1, ... end at 10, which is not a multiple of the
+    // pattern's 3; the end iterator carries the cursor 7 % 2
+    auto const pattern = walked(
+      make_dance_pattern_iterator<1, 2>(std::begin(values)),
+      make_dance_pattern_iterator<1, 2>(std::end(values), 7 % 2));
+    assert((pattern == std::vector<int>{0, 1, 3, 4, 6, 7, 9}));
+
+    auto const cycle = walked(
+      make_dance_cycle_iterator(std::begin(values), {1, 2}),
+      make_dance_cycle_iterator(std::end(values), {1, 2}, 7 % 2));
+    assert(cycle == pattern);
+
+    // 4 steps of 2, 1, 3, 2 end at 8 with cursor 4 % 3
+    auto const three = walked(
+      make_dance_cycle_iterator(std::begin(values), 2, 1, 3),
+      make_dance_cycle_iterator(std::begin(values) + 8, {2, 1, 3}, 4 % 3));
+    assert((three == std::vector<int>{0, 2, 3, 6}));
+
+    // equal only with the matching cursor
+    auto it = make_dance_cycle_iterator(std::begin(values), 2, 1, 3);
+    ++it;
+    ++it;
+    assert(it == make_dance_cycle_iterator(std::begin(values) + 3, {2, 1, 3}, 2));
+    assert(it != make_dance_cycle_iterator(std::begin(values) + 3, {2, 1, 3}, 0));
+
+    // -- undoes ++, also across the pattern's wrap-around
+    auto const first = make_dance_pattern_iterator<2, 1, 3>(std::begin(values));
+    auto walker = first;
+    for(int i = 0; i < 3; ++i) {
+      ++walker;
+    }
+    assert(*walker == 6);
+    assert((walker == make_dance_pattern_iterator<2, 1, 3>(std::begin(values) + 6, 0)));
+    ++walker;
+    --walker;
+    assert(*walker == 6);
+    for(int i = 0; i < 3; ++i) {
+      --walker;
+    }
+    assert(walker == first);
+
+    (void)pattern;
+    (void)cycle;
+    (void)three;
+  }
+} // namespace dance_dance
+
+namespace iterator_tiled {
+  void test()
+  {
+    // sizes that are no multiples of the tiles, including empty ones
+    for(std::ptrdiff_t rows : {0, 1, 7, 33, 300}) {
+      for(std::ptrdiff_t cols : {0, 1, 5, 64, 129, 513}) {
+        std::vector<int> src(static_cast<std::size_t>(rows * cols));
+        std::iota(std::begin(src), std::end(src), 0);
+        auto const matrix = make_matrix_view(std::begin(src), rows, cols);
+
+        std::vector<int> dst(src.size(), -1);
+        blocked_transpose(matrix, make_matrix_view(std::begin(dst), cols, rows));
+        for(std::ptrdiff_t r = 0; r < rows; ++r) {
+          for(std::ptrdiff_t c = 0; c < cols; ++c) {
+            assert(dst[static_cast<std::size_t>(c * rows + r)] == matrix(r, c));
+          }
+        }
+
+        for(std::ptrdiff_t edge : {0, 8, 16}) {
+          std::vector<int> visits(src.size(), 0);
+          tiled_for_each(matrix,
+            [&](int &element, std::ptrdiff_t r, std::ptrdiff_t c) {
+              assert(element == matrix(r, c));
+              ++visits[static_cast<std::size_t>(r * cols + c)];
+            }, edge);
+          assert(std::all_of(std::begin(visits), std::end(visits),
+                             [](int n) { return n == 1; }));
+        }
+      }
+    }
+
+    // a sub-view with a row stride beyond its columns
+    std::vector<int> data(6 * 10);
+    std::iota(std::begin(data), std::end(data), 0);
+    auto const inner = make_matrix_view(std::begin(data), 6, 10).tile(1, 2, 4, 7);
+    assert((inner.rows == 4) && (inner.cols == 7) && (inner(0, 0) == 12));
+    std::vector<int> transposed(4 * 7);
+    blocked_transpose(inner, make_matrix_view(std::begin(transposed), 7, 4));
+    assert((transposed[0] == 12) && (transposed[1] == 22) && (transposed[4] == 13));
+
+    std::size_t tiles = 0U;
+    auto const whole = make_matrix_view(std::begin(data), 6, 10);
+    for(auto it = tiles_begin(whole, 4, 4); it != tiles_end(whole, 4, 4); ++it) {
+      ++tiles;
+    }
+    assert(tiles == 2U * 3U);
+    (void)tiles;
+  }
+} // namespace iterator_tiled
+
+namespace iterator_prefetch {
+  /// walks [first, last) with a prefetching iterator,
+  /// recording what is iterated and what is prefetched
+  template<typename Iterator>
+  std::pair<std::vector<int>, std::vector<int>> walk(
+    Iterator first, Iterator last, std::ptrdiff_t distance)
+  {
+    std::vector<int> iterated;
+    std::vector<int> prefetched;
+    auto const recorder = [&prefetched](Iterator const &it) -> void const * {
+      prefetched.push_back(*it);
+      return std::addressof(*it);
+    };
+    for(auto it = make_prefetch_iterator(first, last, distance, recorder); it != last; ++it) {
+      iterated.push_back(*it);
+    }
+    return {iterated, prefetched};
+  }
+
+  void test()
+  {
+    std::vector<int> const vec{0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    std::list<int> const lst(std::begin(vec), std::end(vec));
+
+    static_assert(std::is_same<
+      decltype(make_prefetch_iterator(std::begin(vec), std::end(vec), 1)),
+      prefetch_iterator<std::vector<int>::const_iterator>>::value, "");
+    static_assert(std::is_same<
+      decltype(make_prefetch_iterator(std::begin(lst), std::end(lst), 1)),
+      lookahead_prefetch_iterator<std::list<int>::const_iterator>>::value, "");
+
+    {
+      // both variants iterate the range unchanged and prefetch
+      // the elements a distance ahead, but nothing beyond the end
+      std::vector<int> const ahead{4, 5, 6, 7, 8, 9};
+      auto const random = walk(std::begin(vec), std::end(vec), 3);
+      assert(random.first == vec);
+      assert(random.second == ahead);
+      auto const lookahead = walk(std::begin(lst), std::end(lst), 3);
+      assert(lookahead.first == vec);
+      assert(lookahead.second == ahead);
+      (void)ahead;
+    }
+
+    {
+      // distances beyond the range prefetch nothing
+      for(std::ptrdiff_t distance : {10, 11, 100}) {
+        auto const random = walk(std::begin(vec), std::end(vec), distance);
+        assert(random.first == vec);
+        assert(random.second.empty());
+        auto const lookahead = walk(std::begin(lst), std::end(lst), distance);
+        assert(lookahead.first == vec);
+        assert(lookahead.second.empty());
+      }
+
+      // as do empty ranges
+      auto const random = walk(std::begin(vec), std::begin(vec), 3);
+      assert(random.first.empty() && random.second.empty());
+      auto const lookahead = walk(std::begin(lst), std::begin(lst), 3);
+      assert(lookahead.first.empty() && lookahead.second.empty());
+    }
+
+    {
+      // distances count in wrapped iterator steps
+      auto const first = make_custom_step_iterator(std::begin(vec), 3);
+      auto const last = make_custom_step_iterator(std::begin(vec) + 9, 3);
+      auto const strided = walk(first, last, 1);
+      assert((strided.first == std::vector<int>{0, 3, 6}));
+      assert((strided.second == std::vector<int>{6}));
+    }
+
+    {
+      // post-increment returns the previous position
+      auto it = make_prefetch_iterator(std::begin(vec), std::end(vec), 2);
+      assert(*it++ == 0);
+      assert(*it == 1);
+      auto jt = make_prefetch_iterator(std::begin(lst), std::end(lst), 2);
+      assert(*jt++ == 0);
+      assert(*jt == 1);
+      (void)it;
+      (void)jt;
+    }
+
+    {
+      // the projection may prefetch the payload an element points to
+      std::vector<int> payloads{10, 20, 30, 40};
+      std::list<int *> pointers;
+      for(auto &&payload : payloads) {
+        pointers.push_back(&payload);
+      }
+      auto const payload = [](std::list<int *>::const_iterator const &it) -> void const * {
+        return *it;
+      };
+      int sum = 0;
+      for(auto it = make_prefetch_iterator(std::cbegin(pointers), std::cend(pointers), 2, payload);
+          it != std::cend(pointers); ++it) {
+        sum += **it;
+      }
+      assert(sum == 100);
+      (void)sum;
+    }
+  }
+} // namespace iterator_prefetch
+
+#if __cplusplus >= 202002L
+namespace iterator_strided_view {
+  constexpr int sumOfEveryThird()
+  {
+    std::array<int, 10> values{{0, 1, 2, 3, 4, 5, 6, 7, 8, 9}};
+    int sum = 0;
+    for(auto value : values | strided(3)) {
+      sum += value;
+    }
+    return sum;
+  }
+
+  void test()
+  {
+    using View = strided_view<std::views::all_t<std::vector<int> &>>;
+    static_assert(std::ranges::view<View>);
+    static_assert(std::ranges::random_access_range<View>);
+    static_assert(std::ranges::sized_range<View>);
+    static_assert(sumOfEveryThird() == 0 + 3 + 6 + 9);
+
+    std::vector<int> values(10);
+    std::iota(std::begin(values), std::end(values), 0);
+
+    // 10 elements are not a multiple of the step; the end is clamped
+    auto const view = make_strided_view(values, 4);
+    assert(view.size() == 3U);
+    assert(view.end() - view.begin() == 3);
+    assert(std::ranges::equal(view, std::vector<int>{0, 4, 8}));
+    assert(view[2] == 8);
+
+    std::vector<int> reversed;
+    for(auto value : values | strided(4) | std::views::reverse) {
+      reversed.push_back(value);
+    }
+    assert((reversed == std::vector<int>{8, 4, 0}));
+
+    for(auto &value : values | strided(3)) {
+      value = -value;
+    }
+    assert((values[9] == -9) && (values[8] == 8));
+
+    std::vector<int> empty;
+    assert((empty | strided(3)).empty());
+    assert(std::ranges::size(values | strided(20)) == 1U);
+  }
+} // namespace iterator_strided_view
+#endif // __cplusplus >= 202002L
+
 int main(int, char **)
 {
   tuple::test();
 
+  tracer::test();
+
   is_any_equal::test();
 
   fire_and_dont_forget::test();
@@ -271,9 +1105,34 @@ int main(int, char **)
 
   print_unmangled::test();
 
+  alloc_tracker::test();
+
+  print_async::test();
+
+  print_deferred::test();
+
+#ifndef _WIN32
+  print_fd::test();
+#endif // _WIN32
+
   print_null::test();
 
+  print_level::test();
+
   resource_pool::test();
 
+  trace_span::test();
+
+  custom_step_algorithm::test();
+
+  dance_dance::test();
+
+  iterator_tiled::test();
+  iterator_prefetch::test();
+
+#if __cplusplus >= 202002L
+  iterator_strided_view::test();
+#endif // __cplusplus >= 202002L
+
   return EXIT_SUCCESS;
 }
@@ -0,0 +1,297 @@
+#ifndef TRACE_SPAN_H
+#define TRACE_SPAN_H
+
+#include <cstddef> // for std::size_t
+#include <iostream> // for std::ostream
+
+#ifdef TRACE_SPANS
+
+#include <atomic> // for std::atomic
+#include <chrono> // for std::chrono::steady_clock
+#include <cstdint> // for std::int64_t
+#include <memory> // for std::shared_ptr
+#include <mutex> // for std::mutex
+#include <vector> // for std::vector
+
+/// number of spans recorded per thread; further spans are dropped
+/// until the buffers are rewound with TraceSpans::Clear
+#ifndef TRACE_SPANS_PER_THREAD
+# define TRACE_SPANS_PER_THREAD 16384
+#endif // TRACE_SPANS_PER_THREAD
+
+namespace trace_span_detail {
+
+  struct Event
+  {
+    char const *name;
+    std::int64_t begin;  // ns
+    std::int64_t end;  // ns
+  };
+
+  /// single-producer buffer written by one thread at a time;
+  /// recorded events are not overwritten while they can be read concurrently,
+  /// i.e. the writing thread rewinds only under the registry's mutex
+  struct Buffer
+  {
+    explicit Buffer(unsigned tid)
+      : tid(tid)
+      , events(new Event[TRACE_SPANS_PER_THREAD]())  // touch the pages up front
+      , count(0U)
+      , dropped(0U)
+      , rewind(false)
+      , leased(false)
+    {}
+
+    /// discard the recorded events; with the registry's mutex held
+    void Rewind()
+    {
+      count.store(0U, std::memory_order_relaxed);
+      dropped.store(0U, std::memory_order_relaxed);
+      rewind.store(false, std::memory_order_relaxed);
+    }
+
+    unsigned const tid;
+    std::unique_ptr<Event[]> const events;
+    std::atomic<std::size_t> count;
+    std::atomic<std::size_t> dropped;
+    std::atomic<bool> rewind;  // requested for the writing thread, set under the mutex
+    bool leased;  // guarded by the registry's mutex
+  };
+
+  struct Registry
+  {
+    std::mutex mtx;
+    std::vector<std::shared_ptr<Buffer>> buffers;  // guarded by mtx
+    std::vector<std::shared_ptr<Buffer>> idle;  // of exited threads, guarded by mtx
+  };
+
+  inline Registry &registry()
+  {
+    static Registry reg;
+    return reg;
+  }
+
+  /// @brief  a thread's claim on a buffer; the buffer of an exited thread
+  ///         is continued by the next new thread, so that memory is bounded
+  ///         by the number of concurrently recording threads
+  /// @note  the continuing thread shows up with the exited one's tid
+  struct Lease
+  {
+    Lease()
+    {
+      auto &reg = registry();
+      std::lock_guard<std::mutex> lock(reg.mtx);
+      if(!reg.idle.empty()) {
+        buf = std::move(reg.idle.back());
+        reg.idle.pop_back();
+      } else {
+        reg.buffers.push_back(
+          std::make_shared<Buffer>(static_cast<unsigned>(reg.buffers.size() + 1U)));
+        buf = reg.buffers.back();
+      }
+      buf->leased = true;
+    }
+
+    ~Lease()
+    {
+      auto &reg = registry();
+      std::lock_guard<std::mutex> lock(reg.mtx);
+      if(buf->rewind.load(std::memory_order_relaxed)) {
+        buf->Rewind();
+      }
+      buf->leased = false;
+
+      // a full buffer stays registered for the dump only, until cleared
+      if(buf->count.load(std::memory_order_relaxed) < TRACE_SPANS_PER_THREAD) {
+        reg.idle.push_back(std::move(buf));
+      }
+    }
+
+    Lease(Lease const &) = delete;
+    Lease &operator=(Lease const &) = delete;
+
+    std::shared_ptr<Buffer> buf;
+  };
+
+  /// @return  the calling thread's buffer, leased on first use
+  inline Buffer &buffer()
+  {
+    thread_local Lease const lease;
+    return *lease.buf;
+  }
+
+  inline std::int64_t now()
+  {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+
+  inline void record(char const *name, std::int64_t begin, std::int64_t end)
+  {
+    auto &buf = buffer();
+    if(buf.rewind.load(std::memory_order_relaxed)) {
+      // rewind the events only while no dump is reading them
+      std::lock_guard<std::mutex> lock(registry().mtx);
+      buf.Rewind();
+    }
+
+    auto const n = buf.count.load(std::memory_order_relaxed);
+    if(n < TRACE_SPANS_PER_THREAD) {
+      buf.events[n] = Event{name, begin, end};
+      buf.count.store(n + 1U, std::memory_order_release);
+    } else {
+      buf.dropped.fetch_add(1U, std::memory_order_relaxed);
+    }
+  }
+
+  inline void writeEscaped(std::ostream &os, char const *str)
+  {
+    for(; *str; ++str) {
+      if((*str == '"') || (*str == '\\')) {
+        os << '\\';
+      }
+      os << *str;
+    }
+  }
+
+  /// write ns as us with three decimals as expected by the trace event format
+  inline void writeMicros(std::ostream &os, std::int64_t ns)
+  {
+    char const digits[] = {
+      static_cast<char>('0' + ns % 1000 / 100),
+      static_cast<char>('0' + ns % 100 / 10),
+      static_cast<char>('0' + ns % 10),
+      '\0'};
+    os << ns / 1000 << '.' << digits;
+  }
+
+} // namespace trace_span_detail
+
+/// @brief  records the lifetime of a scope on the calling thread's timeline;
+///         dump all recorded spans with TraceSpans::WriteJson
+/// @note  use as TraceSpan span("enrich");
+/// @note  the name must outlive the dump, e.g. be a string literal
+/// @note  only active if TRACE_SPANS is defined, compiled out otherwise
+class TraceSpan
+{
+public:
+  explicit TraceSpan(char const *name)
+    : m_name(name)
+    , m_begin(trace_span_detail::now())
+  {}
+
+  ~TraceSpan()
+  {
+    trace_span_detail::record(m_name, m_begin, trace_span_detail::now());
+  }
+
+  TraceSpan(TraceSpan const &) = delete;
+  TraceSpan &operator=(TraceSpan const &) = delete;
+
+private:
+  char const *const m_name;
+  std::int64_t const m_begin;
+};
+
+struct TraceSpans
+{
+  /// @brief  write the spans recorded so far by all threads
+  ///         in the Chrome/Perfetto trace event format
+  /// @note  may be called while threads are still recording
+  static void WriteJson(std::ostream &os)
+  {
+    auto &reg = trace_span_detail::registry();
+    std::lock_guard<std::mutex> lock(reg.mtx);
+
+    os << "{\"traceEvents\":[";
+    char const *separator = "\n";
+    for(auto &&buf : reg.buffers) {
+      if(buf->rewind.load(std::memory_order_relaxed)) {
+        continue;  // cleared
+      }
+      auto const count = buf->count.load(std::memory_order_acquire);
+      for(std::size_t i = 0U; i < count; ++i) {
+        auto const &event = buf->events[i];
+        os << separator << "{\"name\":\"";
+        trace_span_detail::writeEscaped(os, event.name);
+        os << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buf->tid << ",\"ts\":";
+        trace_span_detail::writeMicros(os, event.begin);
+        os << ",\"dur\":";
+        trace_span_detail::writeMicros(os, event.end - event.begin);
+        os << '}';
+        separator = ",\n";
+      }
+    }
+    os << "\n]}\n";
+  }
+
+  /// @return  number of spans dropped because a thread's buffer was full,
+  ///          since the last Clear
+  static std::size_t Dropped()
+  {
+    auto &reg = trace_span_detail::registry();
+    std::lock_guard<std::mutex> lock(reg.mtx);
+
+    std::size_t dropped = 0U;
+    for(auto &&buf : reg.buffers) {
+      if(!buf->rewind.load(std::memory_order_relaxed)) {
+        dropped += buf->dropped.load(std::memory_order_relaxed);
+      }
+    }
+    return dropped;
+  }
+
+  /// @brief  discard the spans recorded so far by all threads,
+  ///         e.g. after writing them, to record the next TRACE_SPANS_PER_THREAD
+  /// @note  the buffers are rewound rather than rings: a full buffer drops
+  ///        new spans until cleared, so a dump never sees events overwritten
+  /// @note  may be called while threads are still recording; a recording
+  ///        thread rewinds its own buffer with its next span
+  static void Clear()
+  {
+    auto &reg = trace_span_detail::registry();
+    std::lock_guard<std::mutex> lock(reg.mtx);
+
+    for(auto &&buf : reg.buffers) {
+      if(buf->leased) {
+        buf->rewind.store(true, std::memory_order_relaxed);
+      } else {
+        // the full buffers of exited threads become available again
+        if(buf->count.load(std::memory_order_relaxed) >= TRACE_SPANS_PER_THREAD) {
+          reg.idle.push_back(buf);
+        }
+        buf->Rewind();
+      }
+    }
+  }
+};
+
+#else // TRACE_SPANS
+
+/// compiled out; define TRACE_SPANS to record spans
+class TraceSpan
+{
+public:
+  explicit TraceSpan(char const *) noexcept
+  {}
+};
+
+struct TraceSpans
+{
+  static void WriteJson(std::ostream &os)
+  {
+    os << "{\"traceEvents\":[]}\n";
+  }
+
+  static std::size_t Dropped()
+  {
+    return 0U;
+  }
+
+  static void Clear()
+  {}
+};
+
+#endif // TRACE_SPANS
+
+#endif // TRACE_SPAN_H
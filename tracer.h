@@ -1,32 +1,99 @@
 #ifndef TRACER_H
 #define TRACER_H
 
+#include <atomic>
 #include <iostream>
 #include <mutex>
 #include <string>
 
+/// snapshot of the Tracer special member function calls
+struct TracerCounts
+{
+  unsigned long constructed = 0;
+  unsigned long copyConstructed = 0;
+  unsigned long moveConstructed = 0;
+  unsigned long copyAssigned = 0;
+  unsigned long moveAssigned = 0;
+  unsigned long destroyed = 0;
+
+  unsigned long copies() const
+  {
+    return copyConstructed + copyAssigned;
+  }
+
+  unsigned long moves() const
+  {
+    return moveConstructed + moveAssigned;
+  }
+
+  /// instances created but not yet destroyed
+  long live() const
+  {
+    return static_cast<long>(constructed + copyConstructed + moveConstructed) -
+           static_cast<long>(destroyed);
+  }
+
+  friend TracerCounts operator-(TracerCounts const &lhs, TracerCounts const &rhs)
+  {
+    TracerCounts diff;
+    diff.constructed = lhs.constructed - rhs.constructed;
+    diff.copyConstructed = lhs.copyConstructed - rhs.copyConstructed;
+    diff.moveConstructed = lhs.moveConstructed - rhs.moveConstructed;
+    diff.copyAssigned = lhs.copyAssigned - rhs.copyAssigned;
+    diff.moveAssigned = lhs.moveAssigned - rhs.moveAssigned;
+    diff.destroyed = lhs.destroyed - rhs.destroyed;
+    return diff;
+  }
+};
+
+/// @brief  prints its special member function calls;
+///         in quiet mode it only counts them, without locking or printing
 struct Tracer
 {
+  struct Counters
+  {
+    std::atomic<unsigned long> constructed{0};
+    std::atomic<unsigned long> copyConstructed{0};
+    std::atomic<unsigned long> moveConstructed{0};
+    std::atomic<unsigned long> copyAssigned{0};
+    std::atomic<unsigned long> moveAssigned{0};
+    std::atomic<unsigned long> destroyed{0};
+  };
+
   static std::mutex mtx;
   static unsigned count;
+  static std::atomic<bool> quiet;
+  static Counters counters;
   std::string name;
 
   Tracer()
   {
+    bump(counters.constructed);
+    if(quiet.load(std::memory_order_relaxed)) {
+      return;
+    }
     std::unique_lock<std::mutex> lock(mtx);
     name = "unnamed_" + std::to_string(count++);
     std::cout << "Tracer '" << name << "' created" << std::endl;
   }
 
   explicit Tracer(char const *name)
-    : name(name)
   {
+    bump(counters.constructed);
+    if(quiet.load(std::memory_order_relaxed)) {
+      return;
+    }
+    this->name = name;
     std::unique_lock<std::mutex> lock(mtx);
     std::cout << "Tracer '" << name << "' created" << std::endl;
   }
 
   Tracer(Tracer const &other)
   {
+    bump(counters.copyConstructed);
+    if(quiet.load(std::memory_order_relaxed)) {
+      return;
+    }
     std::unique_lock<std::mutex> lock(mtx);
     name = other.name + "_cc_" + std::to_string(count++);
     std::cout << "Tracer '" << name << "' "
@@ -34,8 +101,12 @@ struct Tracer
   }
 
   Tracer(Tracer &&other)
-    : name(other.name)
   {
+    bump(counters.moveConstructed);
+    if(quiet.load(std::memory_order_relaxed)) {
+      return;
+    }
+    name = other.name;
     std::unique_lock<std::mutex> lock(mtx);
     other.name += "_mc_" + std::to_string(count++);
     std::cout << "Tracer '" << name << "' "
@@ -44,12 +115,20 @@ struct Tracer
 
   ~Tracer()
   {
+    bump(counters.destroyed);
+    if(quiet.load(std::memory_order_relaxed)) {
+      return;
+    }
     std::unique_lock<std::mutex> lock(mtx);
     std::cout << "Tracer '" << name << "' destroyed" << std::endl;
   }
 
   Tracer &operator=(Tracer const &other)
   {
+    bump(counters.copyAssigned);
+    if(quiet.load(std::memory_order_relaxed)) {
+      return *this;
+    }
     std::unique_lock<std::mutex> lock(mtx);
     name = other.name + "_ca_" + std::to_string(count++);
     std::cout << "Tracer '" << name << "' "
@@ -59,6 +138,10 @@ struct Tracer
 
   Tracer &operator=(Tracer &&other)
   {
+    bump(counters.moveAssigned);
+    if(quiet.load(std::memory_order_relaxed)) {
+      return *this;
+    }
     std::unique_lock<std::mutex> lock(mtx);
     name = std::move(other.name);
     other.name = name + "_ma_" + std::to_string(count++);
@@ -66,9 +149,64 @@ struct Tracer
       "move-assigned from '" << other.name << "'" << std::endl;
     return *this;
   }
+
+  /// @return  the calls counted so far in both modes
+  static TracerCounts Snapshot()
+  {
+    TracerCounts snapshot;
+    snapshot.constructed = counters.constructed.load(std::memory_order_relaxed);
+    snapshot.copyConstructed = counters.copyConstructed.load(std::memory_order_relaxed);
+    snapshot.moveConstructed = counters.moveConstructed.load(std::memory_order_relaxed);
+    snapshot.copyAssigned = counters.copyAssigned.load(std::memory_order_relaxed);
+    snapshot.moveAssigned = counters.moveAssigned.load(std::memory_order_relaxed);
+    snapshot.destroyed = counters.destroyed.load(std::memory_order_relaxed);
+    return snapshot;
+  }
+
+private:
+  static void bump(std::atomic<unsigned long> &counter)
+  {
+    counter.fetch_add(1U, std::memory_order_relaxed);
+  }
 };
 
 unsigned Tracer::count = 0;
 std::mutex Tracer::mtx;
+std::atomic<bool> Tracer::quiet(false);
+Tracer::Counters Tracer::counters;
+
+/// @brief  switches Tracer to quiet mode for its lifetime
+///         and reports the calls counted since its construction
+/// @note  use as
+///          TracerScope scope;
+///          workQueue.Assign(fn, Tracer()).wait();
+///          assert(scope.Counts().copies() == 0);
+class TracerScope
+{
+public:
+  explicit TracerScope(bool quiet = true)
+    : m_wasQuiet(Tracer::quiet.exchange(quiet))
+    , m_start(Tracer::Snapshot())
+  {
+  }
+
+  ~TracerScope()
+  {
+    Tracer::quiet = m_wasQuiet;
+  }
+
+  TracerScope(TracerScope const &) = delete;
+  TracerScope &operator=(TracerScope const &) = delete;
+
+  /// @return  the calls counted since construction
+  TracerCounts Counts() const
+  {
+    return Tracer::Snapshot() - m_start;
+  }
+
+private:
+  bool const m_wasQuiet;
+  TracerCounts const m_start;
+};
 
 #endif // TRACER_H
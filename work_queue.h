@@ -1,26 +1,87 @@
 #ifndef WORK_QUEUE_H
 #define WORK_QUEUE_H
 
+#include "trace_span.h" // for TraceSpan
+
+#include <atomic> // for std::atomic
+#include <chrono> // for std::chrono::steady_clock
 #include <condition_variable> // for std::condition_variable
+#include <exception> // for std::exception_ptr
 #include <functional> // for std::bind
-#include <future> // for std::packaged_task
+#include <future> // for std::promise
+#include <memory> // for std::unique_ptr
 #include <mutex> // for std::mutex
 #include <queue> // for std::queue
+#include <stdexcept> // for std::runtime_error
 #include <thread> // for std::thread
+#include <type_traits> // for std::is_void
+
+/// number of work loads a WorkQueue processed or skipped
+struct WorkQueueCounts
+{
+  unsigned long executed = 0;
+  unsigned long cancelled = 0;  ///< skipped after Handle::Cancel
+  unsigned long expired = 0;  ///< skipped after their deadline
+};
 
 /// std::thread-backed work queue using std::future for return values
 class WorkQueue
 {
 public:
+  using Clock = std::chrono::steady_clock;
+
+  /// treatment of pending work loads on destruction
+  enum class Shutdown
+  {
+    Cancel,  ///< finish the current work load only
+    Drain  ///< finish all pending work loads
+  };
+
+  /// @brief  error of the futures of skipped work loads
+  /// @note  what() tells "cancelled", "expired" or "shut down"
+  struct Cancelled : std::runtime_error
+  {
+    using std::runtime_error::runtime_error;
+  };
+
+  /// @brief  future of a work load that may be cancelled before it starts
+  template<typename ReturnType>
+  class Handle
+  {
+    friend class WorkQueue;
+
+  public:
+    std::future<ReturnType> future;
+
+    /// @brief  skip the work load unless it has started already;
+    ///         the future then throws WorkQueue::Cancelled
+    void Cancel() noexcept
+    {
+      m_cancelled->store(true, std::memory_order_relaxed);
+    }
+
+  private:
+    Handle(std::future<ReturnType> future, std::shared_ptr<std::atomic<bool>> cancelled)
+      : future(std::move(future))
+      , m_cancelled(std::move(cancelled))
+    {}
+
+  private:
+    std::shared_ptr<std::atomic<bool>> m_cancelled;
+  };
+
   /// create an idle work queue
-  WorkQueue()
-    : m_shouldStop(false)
+  explicit WorkQueue(Shutdown shutdown = Shutdown::Cancel)
+    : m_shutdown(shutdown)
+    , m_shouldStop(false)
     , m_thread(&WorkQueue::Worker, this)
   {}
 
   /// @brief  shut down the work queue
-  /// @note  waits for the currently processing work item to be finished,
-  ///        but cancels all further pending ones
+  /// @note  waits for the currently processing work item to be finished;
+  ///        further pending ones are processed or cancelled depending on
+  ///        the Shutdown policy, the futures of cancelled ones throw
+  ///        WorkQueue::Cancelled
   ~WorkQueue()
   {
     // notify the worker
@@ -34,6 +95,18 @@ public:
     if(m_thread.joinable()) {
       m_thread.join();
     }
+
+    // destroying a task may assign another one, e.g. via ResourcePool::GetAsync
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while(!m_queue.empty()) {
+      auto task = std::move(m_queue.front());
+      m_queue.pop();
+
+      lock.unlock();
+      task->Discard("shut down");
+      task.reset();
+      lock.lock();
+    }
   }
 
   /// @brief  assign a work load to the queue
@@ -47,26 +120,56 @@ public:
     typename std::result_of<Fn(Args...)>::type
   >
   Assign(Fn&& fn, Args&&... args)
+  {
+    auto task = MakeTask(std::forward<Fn>(fn), std::forward<Args>(args)...);
+
+    // grab the future to return
+    auto future = task->promise.get_future();
+
+    Enqueue(std::move(task));
+
+    return future;
+  }
+
+  /// @brief  assign a work load that can be cancelled until it starts
+  /// @return  handle to cancel the work load and to wait for its completion
+  template<typename Fn, typename... Args>
+  Handle<
+    typename std::result_of<Fn(Args...)>::type
+  >
+  AssignCancellable(Fn&& fn, Args&&... args)
+  {
+    return AssignUntil(Clock::time_point::max(),
+      std::forward<Fn>(fn), std::forward<Args>(args)...);
+  }
+
+  /// @brief  assign a work load that is skipped unless it starts before deadline
+  /// @return  handle to cancel the work load and to wait for its completion
+  /// @note  the future of an expired work load throws WorkQueue::Cancelled
+  template<typename Fn, typename... Args>
+  Handle<
+    typename std::result_of<Fn(Args...)>::type
+  >
+  AssignUntil(Clock::time_point deadline, Fn&& fn, Args&&... args)
   {
     using ReturnType = typename std::result_of<Fn(Args...)>::type;
-    using BoundTask = typename std::packaged_task<ReturnType()>;
 
-    // make a type-erased task with all its arguments bound
-    auto task = std::make_unique<TypeErased<BoundTask>>(
-      std::bind(std::forward<Fn>(fn), std::forward<Args>(args)...));
+    auto task = MakeTask(std::forward<Fn>(fn), std::forward<Args>(args)...);
+    task->deadline = deadline;
+    task->cancelled = std::make_shared<std::atomic<bool>>(false);
 
-    // grab the future to return
-    std::future<ReturnType> future = task->get_future();
+    Handle<ReturnType> handle(task->promise.get_future(), task->cancelled);
 
-    { // move the task to the back of the work queue
-      std::unique_lock<std::mutex> lock(m_mutex);
-      m_queue.push(std::move(task));
-    }
+    Enqueue(std::move(task));
 
-    // notify the worker
-    m_cv.notify_one();
+    return handle;
+  }
 
-    return future;
+  /// @return  number of work loads processed or skipped so far
+  WorkQueueCounts Counts()
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_counts;
   }
 
 private:
@@ -74,26 +177,85 @@ private:
   {
     virtual ~AbstractTask() = default;
     virtual void operator()() = 0;
+
+    /// fail the future without running the work load
+    virtual void Discard(char const *reason) = 0;
+
+    std::shared_ptr<std::atomic<bool>> cancelled;  // set if cancellable
+    Clock::time_point deadline = Clock::time_point::max();
   };
 
-  template<typename ErasedType>
-  struct TypeErased
-    : public AbstractTask
-    , public ErasedType
+  template<typename ReturnType, typename BoundFn>
+  struct Task : public AbstractTask
   {
-    template<typename... Args>
-    TypeErased(Args&&... args)
-      : ErasedType(std::forward<Args>(args)...)
+    explicit Task(BoundFn&& fn)
+      : fn(std::move(fn))
     {}
 
-    virtual ~TypeErased() = default;
-
     void operator()() override
     {
-      (void)ErasedType::operator()();
+      try {
+        if constexpr(std::is_void<ReturnType>::value) {
+          fn();
+          promise.set_value();
+        } else {
+          promise.set_value(fn());
+        }
+      } catch(...) {
+        promise.set_exception(std::current_exception());
+      }
+    }
+
+    void Discard(char const *reason) override
+    {
+      promise.set_exception(std::make_exception_ptr(Cancelled(reason)));
     }
+
+    BoundFn fn;
+    std::promise<ReturnType> promise;
   };
 
+  /// make a type-erased task with all its arguments bound
+  template<typename Fn, typename... Args>
+  static auto MakeTask(Fn&& fn, Args&&... args)
+  {
+    using ReturnType = typename std::result_of<Fn(Args...)>::type;
+    using BoundFn = decltype(std::bind(std::forward<Fn>(fn), std::forward<Args>(args)...));
+
+    return std::make_unique<Task<ReturnType, BoundFn>>(
+      std::bind(std::forward<Fn>(fn), std::forward<Args>(args)...));
+  }
+
+  void Enqueue(std::unique_ptr<AbstractTask> task)
+  {
+    { // move the task to the back of the work queue
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_queue.push(std::move(task));
+    }
+
+    // notify the worker
+    m_cv.notify_one();
+  }
+
+  using Counter = unsigned long WorkQueueCounts::*;
+
+  /// @brief  run the task or skip it if it was cancelled or has expired
+  /// @return  counter to increment
+  static Counter Process(AbstractTask &task)
+  {
+    if(task.cancelled && task.cancelled->load(std::memory_order_relaxed)) {
+      task.Discard("cancelled");
+      return &WorkQueueCounts::cancelled;
+    } else if((task.deadline != Clock::time_point::max()) && (Clock::now() > task.deadline)) {
+      task.Discard("expired");
+      return &WorkQueueCounts::expired;
+    } else {
+      TraceSpan span("WorkQueue task");
+      task();
+      return &WorkQueueCounts::executed;
+    }
+  }
+
 private:
   inline void Worker()
   {
@@ -106,7 +268,7 @@ private:
           return (!m_queue.empty() || m_shouldStop);
         });
 
-      if(m_shouldStop) {
+      if(m_shouldStop && ((m_shutdown == Shutdown::Cancel) || m_queue.empty())) {
         break;
       } else {
         // get a task from the front of the work queue
@@ -115,18 +277,23 @@ private:
 
         // execute the task while releasing the lock
         lock.unlock();
-        (*task)();
+        auto const counter = Process(*task);
+        task.reset();
         lock.lock();
+
+        ++(m_counts.*counter);
       }
     }
   }
 
 private:
+  Shutdown const m_shutdown;
   std::mutex m_mutex;
   bool m_shouldStop;  // guarded by m_mutex
-  std::thread m_thread;
   std::queue<std::unique_ptr<AbstractTask>> m_queue;  // guarded by m_mutex
+  WorkQueueCounts m_counts;  // guarded by m_mutex
   std::condition_variable m_cv;
+  std::thread m_thread;  // last to start the worker on initialized members only
 };
 
 #endif // WORK_QUEUE_H